@@ -0,0 +1,15 @@
+# checkpoint and resume test of toulbar2
+# interrupts a validation problem and resumes its search (see misc/script/checkpoint-resume.cmake)
+
+SET(CHECKPOINT_PROBLEM "${PROJECT_SOURCE_DIR}/validation/cpd/resume/binary20.wcsp")
+SET(CHECKPOINT_OPTIMUM 269)
+
+ADD_TEST(NAME checkpoint_resume
+  COMMAND ${CMAKE_COMMAND}
+  -DTOULBAR2=${EXECUTABLE_OUTPUT_PATH}/toulbar2${EXE}
+  -DPROBLEM=${CHECKPOINT_PROBLEM}
+  -DCHECKPOINT=${CMAKE_CURRENT_BINARY_DIR}/binary20.checkpoint
+  -DOPTIMUM=${CHECKPOINT_OPTIMUM}
+  -P ${PROJECT_SOURCE_DIR}/misc/script/checkpoint-resume.cmake
+  )
+SET_TESTS_PROPERTIES(checkpoint_resume PROPERTIES TIMEOUT "${Default_test_timeout}")
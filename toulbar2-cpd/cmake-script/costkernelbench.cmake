@@ -0,0 +1,15 @@
+IF(LIBTB2)
+  
+    file(GLOB_RECURSE costkernelbench_file ${My_Source}/costkernelbench.cpp)
+    INCLUDE_DIRECTORIES (${CMAKE_CURRENT_SOURCE_DIR}/${My_Source} )
+    LINK_DIRECTORIES(${CMAKE_CURRENT_SOURCE_DIR}/${LIBRARY_OUTPUT_PATH})
+    add_executable(costkernelbench ${costkernelbench_file})
+    TARGET_LINK_LIBRARIES(costkernelbench tb2)
+    add_dependencies(costkernelbench tb2)
+
+    set_property(
+      TARGET costkernelbench
+      PROPERTY COMPILE_DEFINITIONS NARYCHAR WCSPFORMATONLY ${COST} LINUX ${WIDE_STRING} ${PROBABILITY}
+      )
+
+ENDIF(LIBTB2)
@@ -0,0 +1,16 @@
+IF(LIBTB2)
+  
+    file(GLOB_RECURSE costkernelcheck_file ${My_Source}/costkernelcheck.cpp)
+    INCLUDE_DIRECTORIES (${CMAKE_CURRENT_SOURCE_DIR}/${My_Source} )
+    LINK_DIRECTORIES(${CMAKE_CURRENT_SOURCE_DIR}/${LIBRARY_OUTPUT_PATH})
+    add_executable(costkernelcheck ${costkernelcheck_file})
+    TARGET_LINK_LIBRARIES(costkernelcheck tb2)
+    add_dependencies(costkernelcheck tb2)
+    add_test(NAME costkernelcheck COMMAND costkernelcheck)
+
+    set_property(
+      TARGET costkernelcheck
+      PROPERTY COMPILE_DEFINITIONS NARYCHAR WCSPFORMATONLY ${COST} LINUX ${WIDE_STRING} ${PROBABILITY}
+      )
+
+ENDIF(LIBTB2)
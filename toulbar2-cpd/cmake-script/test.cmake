@@ -22,10 +22,7 @@ ELSE (${Boost_rev} VERSION_GREATER "1.65.0")
     )
 ENDIF (${Boost_rev} VERSION_GREATER "1.65.0")
 
-find_program(COMPUTE bc)
-if(NOT COMPUTE)
-    message(FATAL_ERROR "bc executable not found. Install 'bc' package.")
-endif()
+find_program(COMPUTE bc) # only needed by the problems given with an upper or lower bound file
 
 ################
 # test unitaire
@@ -43,6 +40,10 @@ FOREACH (UTEST ${validation_file})
   STRING(REGEX REPLACE ${BenchMatchString} ".opt" OPTF ${UTEST})
   GET_FILENAME_COMPONENT(TPATH ${UTEST} PATH)
   
+  IF ((EXISTS ${UBF} OR EXISTS ${LBF}) AND NOT COMPUTE)
+    message(FATAL_ERROR "bc executable not found. Install 'bc' package.")
+  ENDIF()
+
   IF (EXISTS ${UBF})
     FILE(READ ${UBF} UB)
     STRING(REPLACE "\n" "" UB ${UB})
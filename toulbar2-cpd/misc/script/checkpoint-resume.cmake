@@ -0,0 +1,23 @@
+# checkpoint and resume round trip of hybrid best-first search
+# the search is first stopped by a time limit while saving its state after each iteration,
+# then it is resumed from the last checkpoint and must find the expected optimum
+#
+# usage: cmake -DTOULBAR2=<executable> -DPROBLEM=<file> -DCHECKPOINT=<file> -DOPTIMUM=<cost> -P checkpoint-resume.cmake
+
+file(REMOVE ${CHECKPOINT})
+
+execute_process(COMMAND ${TOULBAR2} ${PROBLEM} --checkpoint=${CHECKPOINT} --checkpoint-period=0 -timer=1
+  OUTPUT_VARIABLE INTERRUPTED ERROR_VARIABLE INTERRUPTED)
+if (NOT EXISTS ${CHECKPOINT})
+  message(FATAL_ERROR "no checkpoint saved before the time limit:\n${INTERRUPTED}")
+endif()
+
+execute_process(COMMAND ${TOULBAR2} ${PROBLEM} --checkpoint=${CHECKPOINT} --resume
+  OUTPUT_VARIABLE RESUMED ERROR_VARIABLE RESUMED)
+message("${RESUMED}")
+if (NOT RESUMED MATCHES "Resume from checkpoint")
+  message(FATAL_ERROR "search not resumed from ${CHECKPOINT}")
+endif()
+if (NOT RESUMED MATCHES "Optimum: ${OPTIMUM} in")
+  message(FATAL_ERROR "wrong optimum after resuming, expected ${OPTIMUM}")
+endif()
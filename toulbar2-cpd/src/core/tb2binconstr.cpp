@@ -15,19 +15,26 @@ BinaryConstraint::BinaryConstraint(WCSP* wcsp, EnumeratedVariable* xx, Enumerate
     : AbstractBinaryConstraint<EnumeratedVariable, EnumeratedVariable>(wcsp, xx, yy)
     , sizeX(xx->getDomainInitSize())
     , sizeY(yy->getDomainInitSize())
+    , sparse(0)
+    , defaultCost(MIN_COST)
+    , sparseWords(0)
 {
-    deltaCostsX = vector<StoreCost>(sizeX, StoreCost(MIN_COST));
-    deltaCostsY = vector<StoreCost>(sizeY, StoreCost(MIN_COST));
+    deltaCostsX = StoreCostArray(sizeX, MIN_COST);
+    deltaCostsY = StoreCostArray(sizeY, MIN_COST);
     assert(tab.size() == sizeX * sizeY);
     supportX = vector<Value>(sizeX, y->getInf());
     supportY = vector<Value>(sizeY, x->getInf());
     trwsM = vector<Cost>(max(sizeX,sizeY), MIN_COST);
 
-    costs = vector<StoreCost>(sizeX * sizeY, StoreCost(MIN_COST));
-
-    for (unsigned int a = 0; a < x->getDomainInitSize(); a++)
-        for (unsigned int b = 0; b < y->getDomainInitSize(); b++)
-            costs[a * sizeY + b] = tab[a * sizeY + b];
+    bool compact = (Store::getDepth() == 0 && sizeX * sizeY >= CompactTableMinSize);
+    if (!compact || !sparsify(tab)) {
+        costs = StoreCostTable(sizeX * sizeY, MIN_COST);
+        for (unsigned int a = 0; a < x->getDomainInitSize(); a++)
+            for (unsigned int b = 0; b < y->getDomainInitSize(); b++)
+                costs[a * sizeY + b] = tab[a * sizeY + b];
+    }
+    if (compact)
+        costs.narrow();
 
     propagate();
 }
@@ -36,6 +43,9 @@ BinaryConstraint::BinaryConstraint(WCSP* wcsp)
     : AbstractBinaryConstraint<EnumeratedVariable, EnumeratedVariable>(wcsp)
     , sizeX(0)
     , sizeY(0)
+    , sparse(0)
+    , defaultCost(MIN_COST)
+    , sparseWords(0)
 {
     //	unsigned int maxdomainsize = wcsp->getMaxDomainSize();
     //    deltaCostsX = vector<StoreCost>(maxdomainsize,StoreCost(MIN_COST,storeCost));
@@ -51,6 +61,97 @@ BinaryConstraint::BinaryConstraint(WCSP* wcsp)
     //                costs[a * maxdomainsize + b] = MIN_COST;
 }
 
+/// \brief stores only the tuples whose cost differs from the most frequent one, if they are few enough (see ToulBar2::sparseBinaryDensity)
+/// \return false if the table must be stored densely
+bool BinaryConstraint::sparsify(vector<Cost>& tab)
+{
+    size_t size = (size_t)sizeX * sizeY;
+    if (ToulBar2::sparseBinaryDensity <= 0. || size == 0)
+        return false;
+    vector<Cost> sorted(tab.begin(), tab.begin() + size);
+    sort(sorted.begin(), sorted.end());
+    Cost mode = sorted[0];
+    size_t modeCount = 0;
+    for (size_t i = 0, count = 0; i < size; i++) {
+        count = (i > 0 && sorted[i] == sorted[i - 1]) ? count + 1 : 1;
+        if (count > modeCount) {
+            modeCount = count;
+            mode = sorted[i];
+        }
+    }
+    size_t nnz = size - modeCount;
+    if ((double)nnz > ToulBar2::sparseBinaryDensity * size)
+        return false;
+    defaultCost = mode;
+    sparseRowStarts.assign(sizeX + 1, 0);
+    sparseColStarts.assign(sizeY + 1, 0);
+    sparseCols.clear();
+    sparseWords = (sizeY + 63) / 64;
+    sparseBits.assign((size_t)sizeX * sparseWords, 0);
+    vector<Cost> values;
+    for (unsigned int a = 0; a < sizeX; a++) {
+        sparseRowStarts[a] = sparseCols.size();
+        for (unsigned int b = 0; b < sizeY; b++) {
+            if (tab[a * sizeY + b] != defaultCost) {
+                sparseCols.push_back(b);
+                sparseBits[a * sparseWords + b / 64] |= (uint64_t)1 << (b % 64);
+                values.push_back(tab[a * sizeY + b]);
+                sparseColStarts[b + 1]++;
+            }
+        }
+    }
+    sparseRowStarts[sizeX] = sparseCols.size();
+    for (unsigned int b = 0; b < sizeY; b++)
+        sparseColStarts[b + 1] += sparseColStarts[b];
+    sparseRows.resize(nnz);
+    sparsePos.resize(nnz);
+    vector<unsigned int> next(sparseColStarts.begin(), sparseColStarts.end() - 1);
+    for (unsigned int a = 0; a < sizeX; a++) {
+        for (unsigned int p = sparseRowStarts[a]; p < sparseRowStarts[a + 1]; p++) {
+            unsigned int q = next[sparseCols[p]]++;
+            sparseRows[q] = a;
+            sparsePos[q] = p;
+        }
+    }
+    costs = StoreCostTable(nnz, MIN_COST);
+    for (size_t p = 0; p < nnz; p++)
+        costs[p] = values[p];
+    sparse = 1;
+    return true;
+}
+
+/// \brief goes back to a dense table (restored on backtrack)
+void BinaryConstraint::densify()
+{
+    assert(sparse);
+    vector<Cost> dense((size_t)sizeX * sizeY, defaultCost);
+    for (unsigned int a = 0; a < sizeX; a++)
+        for (unsigned int p = sparseRowStarts[a]; p < sparseRowStarts[a + 1]; p++)
+            dense[a * sizeY + sparseCols[p]] = costs[p];
+    costs.assign(dense);
+    sparse = 0;
+}
+
+Cost BinaryConstraint::sparseTableCost(unsigned int ix, unsigned int iy) const
+{
+    ptrdiff_t pos = sparseIndex(ix, iy);
+    return (pos >= 0) ? costs[pos] : defaultCost;
+}
+
+/// \brief modifies a cost of a sparse table, going back to a dense table if a tuple not stored gets a new cost
+void BinaryConstraint::setSparseTableCost(unsigned int ix, unsigned int iy, Cost c)
+{
+    ptrdiff_t pos = sparseIndex(ix, iy);
+    if (pos >= 0) {
+        costs[pos] = c;
+        return;
+    }
+    if (c == defaultCost)
+        return;
+    densify();
+    costs[ix * sizeY + iy] = c;
+}
+
 void BinaryConstraint::print(ostream& os)
 {
     os << this << " BinaryConstraint(" << x->getName() << "," << y->getName() << ")";
@@ -86,7 +187,141 @@ void BinaryConstraint::dump(ostream& os, bool original)
  * Propagation methods
  *
  */
-bool BinaryConstraint::project(EnumeratedVariable* x, Value value, Cost cost, vector<StoreCost>& deltaCostsX)
+
+vector<Cost> BinaryConstraint::kernelAdj;
+vector<Cost> BinaryConstraint::kernelMask;
+vector<unsigned int> BinaryConstraint::kernelOrder;
+
+/// \brief fills kernelAdj and kernelMask for the current domain of \a yy (to be called before kernelMinCost)
+/// \param unary if true, the unary costs of \a yy are added to the binary costs
+void BinaryConstraint::prepareCostKernels(EnumeratedVariable* yy, bool unary)
+{
+    StoreCostArray& deltaCostsY = (yy == y) ? this->deltaCostsY : deltaCostsX;
+    unsigned int size = yy->getDomainInitSize();
+    if (kernelAdj.size() < size) {
+        kernelAdj.resize(size);
+        kernelMask.resize(size);
+    }
+    uint64_t bits[Domain::BitsetWords];
+    if (yy->getDomainBits(bits)) {
+        for (unsigned int j = 0; j < size; j++)
+            kernelMask[j] = -(Cost)((bits[j / 64] >> (j % 64)) & 1); // branchless, vectorized by the compiler
+        for (unsigned int w = 0; w < Domain::BitsetWords; w++) {
+            for (uint64_t word = bits[w]; word; word &= word - 1) {
+                unsigned int yindex = 64 * w + lowestBit(word);
+                kernelAdj[yindex] = deltaCostsY[yindex];
+                if (unary)
+                    kernelAdj[yindex] -= yy->getCost(yy->toValue(yindex));
+            }
+        }
+    } else {
+        fill(kernelMask.begin(), kernelMask.begin() + size, MIN_COST);
+        for (EnumeratedVariable::iterator iterY = yy->begin(); iterY != yy->end(); ++iterY) {
+            unsigned int yindex = yy->toIndex(*iterY);
+            kernelMask[yindex] = (Cost)-1;
+            kernelAdj[yindex] = deltaCostsY[yindex];
+            if (unary)
+                kernelAdj[yindex] -= yy->getCost(*iterY);
+        }
+    }
+    if (sparse) {
+        kernelOrder.clear();
+        for (EnumeratedVariable::iterator iterY = yy->begin(); iterY != yy->end(); ++iterY)
+            kernelOrder.push_back(yy->toIndex(*iterY));
+        stable_sort(kernelOrder.begin(), kernelOrder.end(), [](unsigned int a, unsigned int b) { return kernelAdj[a] > kernelAdj[b]; });
+    }
+}
+
+/// \brief minimum over the current domain of \a yy of the costs of the row (or column) \a xindex of a sparse table, minus kernelAdj
+/// \note only the stored tuples of the row and a few values of kernelOrder are visited: the first value of kernelOrder which is not stored gives the minimum over the tuples costing defaultCost
+Cost BinaryConstraint::sparseMinCost(EnumeratedVariable* xx, unsigned int xindex, unsigned int& yindex)
+{
+    const vector<unsigned int>& starts = (xx == x) ? sparseRowStarts : sparseColStarts;
+    const vector<unsigned int>& indexes = (xx == x) ? sparseCols : sparseRows;
+    Cost minCost = numeric_limits<Cost>::max();
+    yindex = numeric_limits<unsigned int>::max();
+    for (unsigned int p = starts[xindex]; p < starts[xindex + 1]; p++) {
+        unsigned int j = indexes[p];
+        if (kernelMask[j]) {
+            Cost cost = costs[(xx == x) ? p : sparsePos[p]] - kernelAdj[j];
+            if (cost < minCost) {
+                minCost = cost;
+                yindex = j;
+            }
+        }
+    }
+    for (unsigned int k = 0; k < kernelOrder.size(); k++) {
+        unsigned int j = kernelOrder[k];
+        if (!((xx == x) ? sparseStored(xindex, j) : sparseStored(j, xindex))) {
+            Cost cost = defaultCost - kernelAdj[j];
+            if (cost < minCost || (cost == minCost && j < yindex)) {
+                minCost = cost;
+                yindex = j;
+            }
+            break;
+        }
+    }
+    return minCost;
+}
+
+/// \brief finds the minimum cost of \a valueX over the current domain of \a yy using a row or column kernel
+/// \return false if the minimum is negative, in which case a left-to-right scan must be done in order to find the first nonpositive cost
+bool BinaryConstraint::kernelMinCost(EnumeratedVariable* xx, EnumeratedVariable* yy, Value valueX, Cost& minCost, Value& minCostValue)
+{
+    unsigned int xindex = xx->toIndex(valueX);
+    unsigned int yindex = 0;
+    if (sparse)
+        minCost = sparseMinCost(xx, xindex, yindex) - ((xx == x) ? deltaCostsX[xindex] : deltaCostsY[xindex]);
+    else if (xx == x)
+        minCost = rowMinCostKernels[costs.getWidth()](costs.element(xindex * sizeY), costs.getBase(), &kernelAdj[0], &kernelMask[0], sizeY, yindex) - deltaCostsX[xindex];
+    else
+        minCost = columnMinCostKernels[costs.getWidth()](costs.element(xindex), sizeY, costs.getBase(), &kernelAdj[0], &kernelMask[0], sizeX, yindex) - deltaCostsY[xindex];
+    if (minCost < MIN_COST)
+        return false;
+    minCostValue = yy->toValue(yindex);
+    return true;
+}
+/// \brief TRW-S message from \a s to the other variable \e t: \c message[k] = min over the current domain of \a s of \c (theta[j] + cost(j,k)) for each index \e k of the current domain of \e t (the others are set to the largest cost)
+/// \param theta indexed by the domain indexes of \a s (overwritten)
+/// \param mask nonzero for the indexes of the current domain of \a s
+/// \return the minimum of the message
+/// \note uses its own buffers instead of kernelAdj and kernelMask, such that messages of distinct cost functions can be computed concurrently
+Cost BinaryConstraint::messageTRWS(EnumeratedVariable* s, vector<Cost>& theta, const vector<Cost>& mask, vector<Cost>& message) const
+{
+    EnumeratedVariable* t = (s == x) ? y : x;
+    const StoreCostArray& deltaCostsS = (s == x) ? deltaCostsX : deltaCostsY;
+    const StoreCostArray& deltaCostsT = (s == x) ? deltaCostsY : deltaCostsX;
+    message.assign(max(sizeX, sizeY), numeric_limits<Cost>::max());
+    Cost minCost = numeric_limits<Cost>::max();
+    if (!sparse && getCostKernels() != COSTKERNELS_NONE) {
+        vector<Cost>& adj = theta;
+        for (EnumeratedVariable::iterator sIter = s->begin(); sIter != s->end(); ++sIter) {
+            unsigned int j = s->toIndex(*sIter);
+            adj[j] = deltaCostsS[j] - theta[j];
+        }
+        unsigned int argmin = 0;
+        for (EnumeratedVariable::iterator tIter = t->begin(); tIter != t->end(); ++tIter) {
+            unsigned int k = t->toIndex(*tIter);
+            if (s == x)
+                message[k] = columnMinCostKernels[costs.getWidth()](costs.element(k), sizeY, costs.getBase(), &adj[0], &mask[0], sizeX, argmin) - deltaCostsT[k];
+            else
+                message[k] = rowMinCostKernels[costs.getWidth()](costs.element(k * sizeY), costs.getBase(), &adj[0], &mask[0], sizeY, argmin) - deltaCostsT[k];
+            minCost = min(minCost, message[k]);
+        }
+    } else {
+        for (EnumeratedVariable::iterator tIter = t->begin(); tIter != t->end(); ++tIter) {
+            unsigned int k = t->toIndex(*tIter);
+            for (EnumeratedVariable::iterator sIter = s->begin(); sIter != s->end(); ++sIter) {
+                unsigned int j = s->toIndex(*sIter);
+                message[k] = min(message[k], theta[j] + ((s == x) ? tableCost(j, k) : tableCost(k, j)) - (deltaCostsS[j] + deltaCostsT[k]));
+            }
+            minCost = min(minCost, message[k]);
+        }
+    }
+    return minCost;
+}
+
+bool BinaryConstraint::project(EnumeratedVariable* x, Value value, Cost cost, StoreCostArray& deltaCostsX)
 {
     assert(ToulBar2::verbose < 4 || ((cout << "project(C" << getVar(0)->getName() << "," << getVar(1)->getName() << ", (" << x->getName() << "," << value << "), " << cost << ")" << endl), true));
 
@@ -108,7 +343,7 @@ bool BinaryConstraint::project(EnumeratedVariable* x, Value value, Cost cost, ve
     return (x->getSupport() == value || SUPPORTTEST(oldcost, cost));
 }
 
-void BinaryConstraint::extend(EnumeratedVariable* x, Value value, Cost cost, vector<StoreCost>& deltaCostsX)
+void BinaryConstraint::extend(EnumeratedVariable* x, Value value, Cost cost, StoreCostArray& deltaCostsX)
 {
     assert(ToulBar2::verbose < 4 || ((cout << "extend(C" << getVar(0)->getName() << "," << getVar(1)->getName() << ", (" << x->getName() << "," << value << "), " << cost << ")" << endl), true));
 
@@ -9,6 +9,7 @@
 #include "tb2abstractconstr.hpp"
 #include "tb2enumvar.hpp"
 #include "tb2wcsp.hpp"
+#include "tb2costkernels.hpp"
 
 struct Functor_getCost {
     BinaryConstraint& obj;
@@ -31,28 +32,81 @@ class BinaryConstraint : public AbstractBinaryConstraint<EnumeratedVariable, Enu
 protected:
     unsigned int sizeX;
     unsigned int sizeY;
-    vector<StoreCost> deltaCostsX;
-    vector<StoreCost> deltaCostsY;
-    vector<StoreCost> costs;
+    StoreCostArray deltaCostsX;
+    StoreCostArray deltaCostsY;
+    StoreCostTable costs; ///< row-major table of sizeX * sizeY costs, or costs of the stored tuples if sparse
+
+    StoreInt sparse; ///< if nonzero, only the tuples of the sparse pattern are stored, the other ones cost defaultCost
+    Cost defaultCost;
+    vector<unsigned int> sparseRowStarts; ///< for each index of x, position in sparseCols and costs of its first stored tuple (sizeX + 1 elements)
+    vector<unsigned int> sparseCols; ///< index of y of each stored tuple, increasing inside each row
+    vector<unsigned int> sparseColStarts; ///< for each index of y, position in sparseRows and sparsePos of its first stored tuple (sizeY + 1 elements)
+    vector<unsigned int> sparseRows; ///< index of x of each stored tuple, increasing inside each column
+    vector<unsigned int> sparsePos; ///< position in costs of each stored tuple in column order
+    vector<uint64_t> sparseBits; ///< one bit per tuple (set if stored), sparseWords words per row
+    unsigned int sparseWords;
+
+    bool sparseStored(unsigned int ix, unsigned int iy) const { return (sparseBits[ix * sparseWords + iy / 64] >> (iy % 64)) & 1; }
+    /// \return position in costs of a stored tuple, or -1 if it costs defaultCost
+    ptrdiff_t sparseIndex(unsigned int ix, unsigned int iy) const
+    {
+        const uint64_t* row = &sparseBits[ix * sparseWords];
+        unsigned int w = iy / 64;
+        uint64_t bit = (uint64_t)1 << (iy % 64);
+        if (!(row[w] & bit))
+            return -1;
+        ptrdiff_t pos = sparseRowStarts[ix] + bitset<64>(row[w] & (bit - 1)).count();
+        for (unsigned int k = 0; k < w; k++)
+            pos += bitset<64>(row[k]).count();
+        return pos;
+    }
+    Cost sparseTableCost(unsigned int ix, unsigned int iy) const;
+    void setSparseTableCost(unsigned int ix, unsigned int iy, Cost c);
+    // the sparse cases are kept out of line such that the dense accesses remain small enough to be inlined
+    Cost tableCost(unsigned int ix, unsigned int iy) const { return (sparse) ? sparseTableCost(ix, iy) : costs[ix * sizeY + iy]; }
+    void setTableCost(unsigned int ix, unsigned int iy, Cost c)
+    {
+        if (sparse)
+            setSparseTableCost(ix, iy, c);
+        else
+            costs[ix * sizeY + iy] = c;
+    }
+    void addTableCost(unsigned int ix, unsigned int iy, Cost c)
+    {
+        if (c != MIN_COST)
+            setTableCost(ix, iy, tableCost(ix, iy) + c);
+    }
+    bool sparsify(vector<Cost>& tab);
+    void densify();
 
     vector<Value> supportX;
     vector<Value> supportY;
     bool isinspanningtree = false; //pair<bool,int> isInMST
+
+    static const unsigned int CostKernelMinSize = 8; ///< minimum initial domain size to use dense kernels
+    static const unsigned int CompactTableMinSize = 512; ///< minimum number of tuples to store a table sparsely or encode it on fewer bits (smaller tables stay in cache anyway)
+    static vector<Cost> kernelAdj; ///< costs to subtract from a row or column of the cost matrix, including deltaCosts (and minus unary costs if needed)
+    static vector<Cost> kernelMask; ///< nonzero for the values in the current domain
+    static vector<unsigned int> kernelOrder; ///< indexes of the values in the current domain by decreasing kernelAdj (then increasing index), for sparse tables
+    bool useCostKernels(EnumeratedVariable* yy) const { return sparse || (getCostKernels() != COSTKERNELS_NONE && yy->getDomainInitSize() >= CostKernelMinSize && 2 * yy->getDomainSize() >= yy->getDomainInitSize()); }
+    void prepareCostKernels(EnumeratedVariable* yy, bool unary);
+    bool kernelMinCost(EnumeratedVariable* xx, EnumeratedVariable* yy, Value valueX, Cost& minCost, Value& minCostValue);
+    Cost sparseMinCost(EnumeratedVariable* xx, unsigned int xindex, unsigned int& yindex);
     template <typename T>
     void findSupport(T getCost, EnumeratedVariable* x, EnumeratedVariable* y,
-        vector<Value>& supportX, vector<StoreCost>& deltaCostsX);
+        vector<Value>& supportX, StoreCostArray& deltaCostsX);
     template <typename T>
     void findFullSupport(T getCost, EnumeratedVariable* x, EnumeratedVariable* y,
-        vector<Value>& supportX, vector<StoreCost>& deltaCostsX,
-        vector<Value>& supportY, vector<StoreCost>& deltaCostsY);
+        vector<Value>& supportX, StoreCostArray& deltaCostsX,
+        vector<Value>& supportY, StoreCostArray& deltaCostsY);
     template <typename T>
-    void projection(T getCost, EnumeratedVariable* x, EnumeratedVariable* y, Value valueY, vector<StoreCost>& deltaCostsX);
+    void projection(T getCost, EnumeratedVariable* x, EnumeratedVariable* y, Value valueY, StoreCostArray& deltaCostsX);
     template <typename T>
     bool verify(T getCost, EnumeratedVariable* x, EnumeratedVariable* y);
 
     // return true if unary support of x is broken
-    bool project(EnumeratedVariable* x, Value value, Cost cost, vector<StoreCost>& deltaCostsX);
-    void extend(EnumeratedVariable* x, Value value, Cost cost, vector<StoreCost>& deltaCostsX);
+    bool project(EnumeratedVariable* x, Value value, Cost cost, StoreCostArray& deltaCostsX);
+    void extend(EnumeratedVariable* x, Value value, Cost cost, StoreCostArray& deltaCostsX);
 
     void findSupportX() { findSupport(Functor_getCost(*this), x, y, supportX, deltaCostsX); }
     void findSupportY() { findSupport(Functor_getCostReverse(*this), y, x, supportY, deltaCostsY); }
@@ -86,7 +140,7 @@ public:
     {
         unsigned int ix = x->toIndex(vx);
         unsigned int iy = y->toIndex(vy);
-        Cost res = costs[ix * sizeY + iy];
+        Cost res = tableCost(ix, iy);
         //if (res >= wcsp->getUb() || res - deltaCostsX[ix] - deltaCostsY[iy] + wcsp->getLb() >= wcsp->getUb()) return wcsp->getUb();
         res -= deltaCostsX[ix] + deltaCostsY[iy];
         assert(res >= MIN_COST);
@@ -96,11 +150,12 @@ public:
     {
         unsigned int ix = x->toIndex(vx);
         unsigned int iy = y->toIndex(vy);
-        return costs[ix * sizeY + iy] - (deltaCostsX[ix] + deltaCostsY[iy]);
+        return tableCost(ix, iy) - (deltaCostsX[ix] + deltaCostsY[iy]);
     }
+    Cost messageTRWS(EnumeratedVariable* s, vector<Cost>& theta, const vector<Cost>& mask, vector<Cost>& message) const;
     void projectTRWS(EnumeratedVariable *var, Value value, Cost cost)
     {
-        vector<StoreCost> &deltaCosts = (var == x)? deltaCostsX: deltaCostsY;
+        StoreCostArray& deltaCosts = (var == x)? deltaCostsX: deltaCostsY;
         deltaCosts[var->toIndex(value)] += cost;
         var->project(value, cost, true);
     }
@@ -111,7 +166,7 @@ public:
             unsigned int ix = x->toIndex(*xIter);
             for (EnumeratedVariable::iterator yIter = y->begin(); yIter != y->end(); ++yIter) {
                 unsigned int iy = y->toIndex(*yIter);
-                minCost = min<Cost>(minCost, costs[ix * sizeY + iy] - (deltaCostsX[ix] + deltaCostsY[iy]));
+                minCost = min<Cost>(minCost, tableCost(ix, iy) - (deltaCostsX[ix] + deltaCostsY[iy]));
             }
         }
         if (minCost != MIN_COST) {
@@ -119,7 +174,7 @@ public:
                 unsigned int ix = x->toIndex(*xIter);
                 for (EnumeratedVariable::iterator yIter = y->begin(); yIter != y->end(); ++yIter) {
                     unsigned int iy = y->toIndex(*yIter);
-                    costs[ix * sizeY + iy] -= minCost;
+                    addTableCost(ix, iy, -minCost);
                 }
             }
         }
@@ -131,7 +186,7 @@ public:
         unsigned int vindex[2];
         vindex[getIndex(xx)] = xx->toIndex(vx);
         vindex[getIndex(yy)] = yy->toIndex(vy);
-        Cost res = costs[vindex[0] * sizeY + vindex[1]];
+        Cost res = tableCost(vindex[0], vindex[1]);
         //if (res >= wcsp->getUb() || res - deltaCostsX[vindex[0]] - deltaCostsY[vindex[1]] + wcsp->getLb() >= wcsp->getUb()) return wcsp->getUb();
         res -= deltaCostsX[vindex[0]] + deltaCostsY[vindex[1]];
         assert(res >= MIN_COST);
@@ -151,7 +206,7 @@ public:
         assert(mincost >= MIN_COST || !LUBTEST(getCost(vx, vy), -mincost) || ToulBar2::isZ); // Warning! negative costs can be added temporally by variable elimination on the fly
         unsigned int ix = x->toIndex(vx);
         unsigned int iy = y->toIndex(vy);
-        costs[ix * sizeY + iy] += mincost;
+        addTableCost(ix, iy, mincost);
     }
 
     void addcost(EnumeratedVariable* xin, EnumeratedVariable* yin, Value vx, Value vy, Cost mincost)
@@ -159,9 +214,9 @@ public:
         assert(ToulBar2::verbose < 4 || ((cout << "addcost(C" << xin->getName() << "," << yin->getName() << "," << vx << "," << vy << "), " << mincost << ")" << endl), true));
         assert(mincost >= MIN_COST || !LUBTEST(getCost(xin, yin, vx, vy), -mincost));
         if (xin == x) {
-            costs[x->toIndex(vx) * sizeY + y->toIndex(vy)] += mincost;
+            addTableCost(x->toIndex(vx), y->toIndex(vy), mincost);
         } else {
-            costs[x->toIndex(vy) * sizeY + y->toIndex(vx)] += mincost;
+            addTableCost(x->toIndex(vy), y->toIndex(vx), mincost);
         }
     }
 
@@ -169,22 +224,22 @@ public:
     {
         for (unsigned int a = 0; a < sizeX; a++)
             for (unsigned int b = 0; b < sizeY; b++)
-                costs[a * sizeY + b] = c;
+                setTableCost(a, b, c);
     }
 
     void setcost(EnumeratedVariable* xin, EnumeratedVariable* yin, Value vx, Value vy, Cost mincost)
     {
         assert(ToulBar2::verbose < 4 || ((cout << "setcost(C" << xin->getName() << "," << yin->getName() << "," << vx << "," << vy << "), " << mincost << ")" << endl), true));
         if (xin == x)
-            costs[x->toIndex(vx) * sizeY + y->toIndex(vy)] = mincost;
+            setTableCost(x->toIndex(vx), y->toIndex(vy), mincost);
         else
-            costs[x->toIndex(vy) * sizeY + y->toIndex(vx)] = mincost;
+            setTableCost(x->toIndex(vy), y->toIndex(vx), mincost);
     }
 
     void setcost(Value vx, Value vy, Cost mincost)
     {
         assert(ToulBar2::verbose < 4 || ((cout << "setcost(C" << getVar(0)->getName() << "," << getVar(1)->getName() << "," << vx << "," << vy << "), " << mincost << ")" << endl), true));
-        costs[x->toIndex(vx) * sizeY + y->toIndex(vy)] = mincost;
+        setTableCost(x->toIndex(vx), y->toIndex(vy), mincost);
     }
 
     void addCosts(EnumeratedVariable* xin, EnumeratedVariable* yin, vector<Cost>& costsin)
@@ -197,9 +252,9 @@ public:
                 ix = x->toIndex(*iterx);
                 iy = y->toIndex(*itery);
                 if (xin == x)
-                    costs[ix * sizeY + iy] += costsin[ix * sizeY + iy];
+                    addTableCost(ix, iy, costsin[ix * sizeY + iy]);
                 else
-                    costs[ix * sizeY + iy] += costsin[iy * sizeX + ix];
+                    addTableCost(ix, iy, costsin[iy * sizeX + ix]);
             }
         }
     }
@@ -213,10 +268,10 @@ public:
             for (EnumeratedVariable::iterator itery = y->begin(); itery != y->end(); ++itery) {
                 ix = x->toIndex(*iterx);
                 iy = y->toIndex(*itery);
-                Cost c = costs[ix * sizeY + iy];
+                Cost c = tableCost(ix, iy);
                 //if(costs[ix * sizeY + iy] < wcsp->getUb()) //BUG with BTD: ub is only local, deltaCosts should be considered
                 {
-                    costs[ix * sizeY + iy] = c + xy->getCost(x, y, *iterx, *itery);
+                    setTableCost(ix, iy, c + xy->getCost(x, y, *iterx, *itery));
                 }
             }
         }
@@ -231,7 +286,7 @@ public:
             deltaCostsY[j] = MIN_COST;
         for (unsigned int i = 0; i < sizeX; i++) {
             for (unsigned int j = 0; j < sizeY; j++) {
-                costs[i * sizeY + j] = MIN_COST;
+                setTableCost(i, j, MIN_COST);
             }
         }
     }
@@ -243,10 +298,10 @@ public:
             unsigned int ix = x->toIndex(*iterx);
             for (EnumeratedVariable::iterator itery = y->begin(); itery != y->end(); ++itery) {
                 unsigned int iy = y->toIndex(*itery);
-                Cost cost = costs[ix * sizeY + iy];
+                Cost cost = tableCost(ix, iy);
                 Cost delta = deltaCostsX[ix] + deltaCostsY[iy];
                 if (CUT(cost - delta, ub))
-                    costs[ix * sizeY + iy] = mult_ub + delta;
+                    setTableCost(ix, iy, mult_ub + delta);
             }
         }
     }
@@ -359,17 +414,16 @@ public:
         sizeX = x->getDomainInitSize();
         sizeY = y->getDomainInitSize();
         if (sizeX > deltaCostsX.size())
-            deltaCostsX.resize(sizeX, StoreCost(MIN_COST));
+            deltaCostsX.resize(sizeX, MIN_COST);
         if (sizeY > deltaCostsY.size())
-            deltaCostsY.resize(sizeY, StoreCost(MIN_COST));
+            deltaCostsY.resize(sizeY, MIN_COST);
         if (sizeX > supportX.size())
             supportX.resize(sizeX);
         if (sizeY > supportY.size())
             supportY.resize(sizeY);
         if (max(sizeX,sizeY) > trwsM.size())
             trwsM.resize(max(sizeX,sizeY), MIN_COST);
-        if (sizeX * sizeY > costs.size())
-            costs.resize(sizeX * sizeY, StoreCost(MIN_COST));
+        costs.enlarge(sizeX * sizeY, MIN_COST);
         linkX->removed = true;
         linkY->removed = true;
         linkX->content.constr = this;
@@ -596,7 +650,7 @@ public:
     void print(ostream& os);
     void dump(ostream& os, bool original = true);
     Long size() const FINAL { return (Long)sizeX * sizeY; }
-    Long space() const FINAL { return (Long)sizeof(StoreCost) * sizeX * sizeY; }
+    Long space() const FINAL { return (Long)costs.memory() + (Long)sizeof(unsigned int) * (sparseRowStarts.size() + sparseCols.size() + sparseColStarts.size() + sparseRows.size() + sparsePos.size()) + (Long)sizeof(uint64_t) * sparseBits.size(); }
 
     friend struct Functor_getCost;
     friend struct Functor_getCostReverse;
@@ -617,24 +671,30 @@ inline Cost Functor_getCostReverse::operator()(EnumeratedVariable* yy, Enumerate
 
 template <typename T>
 void BinaryConstraint::findSupport(T getCost, EnumeratedVariable* x, EnumeratedVariable* y,
-    vector<Value>& supportX, vector<StoreCost>& deltaCostsX)
+    vector<Value>& supportX, StoreCostArray& deltaCostsX)
 {
     assert(connected());
     wcsp->revise(this);
     if (ToulBar2::verbose >= 3)
         cout << "findSupport C" << x->getName() << "," << y->getName() << endl;
     bool supportBroken = false;
+    bool kernel = useCostKernels(y);
+    if (kernel)
+        prepareCostKernels(y, false);
     for (EnumeratedVariable::iterator iterX = x->begin(); iterX != x->end(); ++iterX) {
         unsigned int xindex = x->toIndex(*iterX);
         Value support = supportX[xindex];
         if (y->cannotbe(support) || getCost(x, y, *iterX, support) > MIN_COST) {
             Value minCostValue = y->getInf();
-            Cost minCost = getCost(x, y, *iterX, minCostValue);
-            EnumeratedVariable::iterator iterY = y->begin();
-            for (++iterY; minCost > MIN_COST && iterY != y->end(); ++iterY) {
-                Cost cost = getCost(x, y, *iterX, *iterY);
-                if (GLB(&minCost, cost)) {
-                    minCostValue = *iterY;
+            Cost minCost = MIN_COST;
+            if (!kernel || !kernelMinCost(x, y, *iterX, minCost, minCostValue)) {
+                minCost = getCost(x, y, *iterX, minCostValue);
+                EnumeratedVariable::iterator iterY = y->begin();
+                for (++iterY; minCost > MIN_COST && iterY != y->end(); ++iterY) {
+                    Cost cost = getCost(x, y, *iterX, *iterY);
+                    if (GLB(&minCost, cost)) {
+                        minCostValue = *iterY;
+                    }
                 }
             }
             if (minCost > MIN_COST) {
@@ -652,25 +712,31 @@ void BinaryConstraint::findSupport(T getCost, EnumeratedVariable* x, EnumeratedV
 
 template <typename T>
 void BinaryConstraint::findFullSupport(T getCost, EnumeratedVariable* x, EnumeratedVariable* y,
-    vector<Value>& supportX, vector<StoreCost>& deltaCostsX,
-    vector<Value>& supportY, vector<StoreCost>& deltaCostsY)
+    vector<Value>& supportX, StoreCostArray& deltaCostsX,
+    vector<Value>& supportY, StoreCostArray& deltaCostsY)
 {
     assert(connected());
     wcsp->revise(this);
     if (ToulBar2::verbose >= 3)
         cout << "findFullSupport C" << x->getName() << "," << y->getName() << endl;
     bool supportBroken = false;
+    bool kernel = useCostKernels(y); // extending unary costs of y keeps their sum with binary costs, so kernelAdj remains valid
+    if (kernel)
+        prepareCostKernels(y, true);
     for (EnumeratedVariable::iterator iterX = x->begin(); iterX != x->end(); ++iterX) {
         unsigned int xindex = x->toIndex(*iterX);
         Value support = supportX[xindex];
         if (y->cannotbe(support) || getCost(x, y, *iterX, support) + y->getCost(support) > MIN_COST) {
             Value minCostValue = y->getInf();
-            Cost minCost = getCost(x, y, *iterX, minCostValue) + y->getCost(minCostValue);
-            EnumeratedVariable::iterator iterY = y->begin();
-            for (++iterY; minCost > MIN_COST && iterY != y->end(); ++iterY) {
-                Cost cost = getCost(x, y, *iterX, *iterY) + y->getCost(*iterY);
-                if (GLB(&minCost, cost)) {
-                    minCostValue = *iterY;
+            Cost minCost = MIN_COST;
+            if (!kernel || !kernelMinCost(x, y, *iterX, minCost, minCostValue)) {
+                minCost = getCost(x, y, *iterX, minCostValue) + y->getCost(minCostValue);
+                EnumeratedVariable::iterator iterY = y->begin();
+                for (++iterY; minCost > MIN_COST && iterY != y->end(); ++iterY) {
+                    Cost cost = getCost(x, y, *iterX, *iterY) + y->getCost(*iterY);
+                    if (GLB(&minCost, cost)) {
+                        minCostValue = *iterY;
+                    }
                 }
             }
             if (minCost > MIN_COST) {
@@ -699,7 +765,7 @@ void BinaryConstraint::findFullSupport(T getCost, EnumeratedVariable* x, Enumera
 }
 
 template <typename T>
-void BinaryConstraint::projection(T getCost, EnumeratedVariable* x, EnumeratedVariable* y, Value valueY, vector<StoreCost>& deltaCostsX)
+void BinaryConstraint::projection(T getCost, EnumeratedVariable* x, EnumeratedVariable* y, Value valueY, StoreCostArray& deltaCostsX)
 {
     x->queueDEE();
     bool supportBroken = false;
@@ -718,16 +784,23 @@ void BinaryConstraint::projection(T getCost, EnumeratedVariable* x, EnumeratedVa
 template <typename T>
 bool BinaryConstraint::verify(T getCost, EnumeratedVariable* x, EnumeratedVariable* y)
 {
+    bool kernel = useCostKernels(y);
+    if (kernel)
+        prepareCostKernels(y, ToulBar2::LcLevel >= LC_DAC && getDACScopeIndex() == getIndex(x));
     for (EnumeratedVariable::iterator iterX = x->begin(); iterX != x->end(); ++iterX) {
-        Cost minCost = getCost(x, y, *iterX, y->getInf());
-        if (ToulBar2::LcLevel >= LC_DAC && getDACScopeIndex() == getIndex(x))
-            minCost += y->getCost(y->getInf());
-        EnumeratedVariable::iterator iterY = y->begin();
-        for (++iterY; minCost > MIN_COST && iterY != y->end(); ++iterY) {
-            Cost cost = getCost(x, y, *iterX, *iterY);
+        Cost minCost = MIN_COST;
+        Value minCostValue = y->getInf();
+        if (!kernel || !kernelMinCost(x, y, *iterX, minCost, minCostValue)) {
+            minCost = getCost(x, y, *iterX, y->getInf());
             if (ToulBar2::LcLevel >= LC_DAC && getDACScopeIndex() == getIndex(x))
-                cost += y->getCost(*iterY);
-            GLB(&minCost, cost);
+                minCost += y->getCost(y->getInf());
+            EnumeratedVariable::iterator iterY = y->begin();
+            for (++iterY; minCost > MIN_COST && iterY != y->end(); ++iterY) {
+                Cost cost = getCost(x, y, *iterX, *iterY);
+                if (ToulBar2::LcLevel >= LC_DAC && getDACScopeIndex() == getIndex(x))
+                    cost += y->getCost(*iterY);
+                GLB(&minCost, cost);
+            }
         }
         if (minCost > MIN_COST) {
             cout << *this;
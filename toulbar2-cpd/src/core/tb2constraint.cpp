@@ -4,6 +4,7 @@
 
 #include "tb2constraint.hpp"
 #include "tb2wcsp.hpp"
+#include "tb2naryconstr.hpp"
 #include "search/tb2clusters.hpp"
 
 /*
@@ -22,6 +23,8 @@ Constraint::Constraint(WCSP* w)
     isSep_ = false;
     isDuplicate_ = false;
     cluster = -1;
+    waveStamp = 0;
+    waveIndexes = 0;
 }
 
 Constraint::Constraint(WCSP* w, int elimCtrIndex)
@@ -34,6 +37,8 @@ Constraint::Constraint(WCSP* w, int elimCtrIndex)
     isSep_ = false;
     isDuplicate_ = false;
     cluster = -1;
+    waveStamp = 0;
+    waveIndexes = 0;
 }
 
 /// \return size of the cartesian product of all domains in the constraint scope.
@@ -323,11 +328,16 @@ Constraint* Constraint::copy()
     for (int i = 0; i < arity(); i++)
         scope[i] = getVar(i)->wcspIndex;
     int ctrIndex = wcsp->postNaryConstraintBegin(scope, arity(), getDefCost(), size());
-    Cost c;
-    String t;
-    first();
-    while (next(t, c)) {
-        wcsp->postNaryConstraintTuple(ctrIndex, t, c);
+    Constraint* ctr = wcsp->getCtr(ctrIndex);
+    if (isNary() && ctr->isNary() && ((NaryConstraint*)this)->dense() && ((NaryConstraint*)ctr)->dense()) {
+        ((NaryConstraint*)ctr)->copyDense((NaryConstraint*)this);
+    } else {
+        Cost c;
+        String t;
+        first();
+        while (next(t, c)) {
+            wcsp->postNaryConstraintTuple(ctrIndex, t, c);
+        }
     }
     wcsp->getCtr(ctrIndex)->deconnect();
     return wcsp->getCtr(ctrIndex);
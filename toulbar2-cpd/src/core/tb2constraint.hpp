@@ -100,6 +100,14 @@ public:
     virtual void increase(int index) { propagate(); }
     virtual void decrease(int index) { propagate(); }
     virtual void remove(int index) { propagate(); }
+    /// \brief same as calling remove for each scope index whose bit is set in \a indexes (see ToulBar2::propagationWaves)
+    virtual void removes(uint64_t indexes)
+    {
+        for (int i = 0; indexes; i++, indexes >>= 1) {
+            if ((indexes & 1) && connected())
+                remove(i);
+        }
+    }
     virtual void projectFromZero(int index) {}
     virtual void assign(int index) { propagate(); }
     void assigns();
@@ -272,6 +280,9 @@ public:
     void setCluster(int i) { cluster = i; }
     void assignCluster();
 
+    Long waveStamp; ///< last wave of WCSP::propagateACWaves where the cost function has been collected
+    uint64_t waveIndexes; ///< scope indexes (one bit each) of the variables which have lost values during this wave
+
     bool isSep_;
     void setSep() { isSep_ = true; }
     bool isSep() { return isSep_; }
@@ -0,0 +1,357 @@
+/*
+ * **************** Dense kernels over cost matrices *******************
+ *
+ * Vector versions keep, for each lane, the minimum found so far and its
+ * index (strict comparison, so the first one), then reduce the lanes by
+ * choosing the smallest index among those reaching the global minimum.
+ * The result is thus identical to a left-to-right scalar scan.
+ *
+ * Narrow encodings (16 or 32-bit unsigned offsets from a base cost) are
+ * widened to 64 bits in registers. Columns of narrow matrices are read by
+ * 32-bit gathers (keeping the low 16 bits for 16-bit offsets, which may read
+ * two bytes after the last element, see ::StoreCostTable).
+ *
+ * Dead-end elimination kernels are element-wise (no reduction), AVX2 lacking
+ * 64-bit min/max instructions they use comparisons and blends.
+ */
+
+#include "tb2costkernels.hpp"
+
+#if defined(LONGLONG_COST) && defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define COSTKERNELS_X86
+#endif
+
+template <class T>
+static Cost rowMinCostScalar(const void* row_, Cost base, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin)
+{
+    const T* row = (const T*)row_;
+    Cost minCost = numeric_limits<Cost>::max();
+    argmin = size;
+    for (unsigned int j = 0; j < size; j++) {
+        if (mask[j]) {
+            Cost cost = base + (Cost)row[j] - adj[j];
+            if (cost < minCost) {
+                minCost = cost;
+                argmin = j;
+            }
+        }
+    }
+    return minCost;
+}
+
+template <class T>
+static Cost columnMinCostScalar(const void* col_, unsigned int stride, Cost base, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin)
+{
+    const T* col = (const T*)col_;
+    Cost minCost = numeric_limits<Cost>::max();
+    argmin = size;
+    for (unsigned int j = 0; j < size; j++) {
+        if (mask[j]) {
+            Cost cost = base + (Cost)col[(size_t)j * stride] - adj[j];
+            if (cost < minCost) {
+                minCost = cost;
+                argmin = j;
+            }
+        }
+    }
+    return minCost;
+}
+
+static void maxDiffCostScalar(Cost* diff, Cost ca, const Cost* col, const Cost* mask, unsigned int size)
+{
+    for (unsigned int j = 0; j < size; j++) {
+        if (mask[j] && ca - col[j] > diff[j])
+            diff[j] = ca - col[j];
+    }
+}
+
+static void boundedSumCostScalar(Cost* sum, const Cost* add, Cost cap, unsigned int size)
+{
+    for (unsigned int j = 0; j < size; j++) {
+        sum[j] = min(sum[j] + min(add[j], cap), cap);
+    }
+}
+
+#ifdef COSTKERNELS_X86
+/// \brief combines per-lane minima and indexes into the first index reaching the overall minimum
+static inline Cost reduceLanes(const Cost* mins, const Cost* args, int lanes, unsigned int size, unsigned int& argmin)
+{
+    Cost minCost = numeric_limits<Cost>::max();
+    argmin = size;
+    for (int l = 0; l < lanes; l++) {
+        if (mins[l] < minCost || (mins[l] == minCost && (unsigned int)args[l] < argmin)) {
+            minCost = mins[l];
+            argmin = args[l];
+        }
+    }
+    return minCost;
+}
+
+// loads of 4 (AVX2) or 8 (AVX-512) consecutive elements widened to 64 bits (zero-masked AVX-512 conversions, see gathers below)
+__attribute__((target("avx2"))) static inline __m256i load4(const Cost* p) { return _mm256_loadu_si256((const __m256i*)p); }
+__attribute__((target("avx2"))) static inline __m256i load4(const uint32_t* p) { return _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)p)); }
+__attribute__((target("avx2"))) static inline __m256i load4(const uint16_t* p) { return _mm256_cvtepu16_epi64(_mm_loadl_epi64((const __m128i*)p)); }
+__attribute__((target("avx512f"))) static inline __m512i load8(const Cost* p) { return _mm512_loadu_si512((const void*)p); }
+__attribute__((target("avx512f"))) static inline __m512i load8(const uint32_t* p) { return _mm512_maskz_cvtepu32_epi64(0xFF, _mm256_loadu_si256((const __m256i*)p)); }
+__attribute__((target("avx512f"))) static inline __m512i load8(const uint16_t* p) { return _mm512_maskz_cvtepu16_epi64(0xFF, _mm_loadu_si128((const __m128i*)p)); }
+
+// gathers of 4 (AVX2) or 8 (AVX-512) elements at element offsets widened to 64 bits
+// (AVX-512 versions start from zero registers, the unmasked intrinsics leaving them undefined, which GCC reports as uninitialized)
+__attribute__((target("avx2"))) static inline __m256i gather4(const Cost* p, __m256i offset) { return _mm256_i64gather_epi64((const long long*)p, offset, 8); }
+__attribute__((target("avx2"))) static inline __m256i gather4(const uint32_t* p, __m256i offset) { return _mm256_cvtepu32_epi64(_mm256_i64gather_epi32((const int*)p, offset, 4)); }
+__attribute__((target("avx2"))) static inline __m256i gather4(const uint16_t* p, __m256i offset) { return _mm256_and_si256(_mm256_cvtepu32_epi64(_mm256_i64gather_epi32((const int*)p, offset, 2)), _mm256_set1_epi64x(0xFFFF)); }
+__attribute__((target("avx512f"))) static inline __m512i gather8(const Cost* p, __m512i offset) { return _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xFF, offset, (const void*)p, 8); }
+__attribute__((target("avx512f"))) static inline __m512i gather8(const uint32_t* p, __m512i offset) { return _mm512_maskz_cvtepu32_epi64(0xFF, _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), 0xFF, offset, (const void*)p, 4)); }
+__attribute__((target("avx512f"))) static inline __m512i gather8(const uint16_t* p, __m512i offset) { return _mm512_and_si512(_mm512_maskz_cvtepu32_epi64(0xFF, _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), 0xFF, offset, (const void*)p, 2)), _mm512_set1_epi64(0xFFFF)); }
+
+template <class T>
+__attribute__((target("avx2"))) static Cost rowMinCostAVX2(const void* row_, Cost base, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin)
+{
+    const T* row = (const T*)row_;
+    const __m256i maxv = _mm256_set1_epi64x(numeric_limits<Cost>::max());
+    const __m256i basev = _mm256_set1_epi64x(base);
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i minv = maxv;
+    __m256i argv = _mm256_set1_epi64x(size);
+    __m256i idx = _mm256_setr_epi64x(0, 1, 2, 3);
+    unsigned int j = 0;
+    for (; j + 4 <= size; j += 4) {
+        __m256i cost = _mm256_sub_epi64(_mm256_add_epi64(load4(row + j), basev), _mm256_loadu_si256((const __m256i*)(adj + j)));
+        cost = _mm256_blendv_epi8(maxv, cost, _mm256_loadu_si256((const __m256i*)(mask + j)));
+        __m256i lt = _mm256_cmpgt_epi64(minv, cost);
+        minv = _mm256_blendv_epi8(minv, cost, lt);
+        argv = _mm256_blendv_epi8(argv, idx, lt);
+        idx = _mm256_add_epi64(idx, step);
+    }
+    Cost mins[4], args[4];
+    _mm256_storeu_si256((__m256i*)mins, minv);
+    _mm256_storeu_si256((__m256i*)args, argv);
+    Cost minCost = reduceLanes(mins, args, 4, size, argmin);
+    for (; j < size; j++) {
+        if (mask[j] && base + (Cost)row[j] - adj[j] < minCost) {
+            minCost = base + (Cost)row[j] - adj[j];
+            argmin = j;
+        }
+    }
+    return minCost;
+}
+
+template <class T>
+__attribute__((target("avx2"))) static Cost columnMinCostAVX2(const void* col_, unsigned int stride, Cost base, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin)
+{
+    const T* col = (const T*)col_;
+    const __m256i maxv = _mm256_set1_epi64x(numeric_limits<Cost>::max());
+    const __m256i basev = _mm256_set1_epi64x(base);
+    const __m256i step = _mm256_set1_epi64x(4);
+    const __m256i offsetStep = _mm256_set1_epi64x(4 * (Long)stride);
+    __m256i minv = maxv;
+    __m256i argv = _mm256_set1_epi64x(size);
+    __m256i idx = _mm256_setr_epi64x(0, 1, 2, 3);
+    __m256i offset = _mm256_setr_epi64x(0, stride, 2 * (Long)stride, 3 * (Long)stride);
+    unsigned int j = 0;
+    for (; j + 4 <= size; j += 4) {
+        __m256i present = _mm256_loadu_si256((const __m256i*)(mask + j));
+        __m256i cost = _mm256_sub_epi64(_mm256_add_epi64(gather4(col, offset), basev), _mm256_loadu_si256((const __m256i*)(adj + j)));
+        cost = _mm256_blendv_epi8(maxv, cost, present);
+        __m256i lt = _mm256_cmpgt_epi64(minv, cost);
+        minv = _mm256_blendv_epi8(minv, cost, lt);
+        argv = _mm256_blendv_epi8(argv, idx, lt);
+        idx = _mm256_add_epi64(idx, step);
+        offset = _mm256_add_epi64(offset, offsetStep);
+    }
+    Cost mins[4], args[4];
+    _mm256_storeu_si256((__m256i*)mins, minv);
+    _mm256_storeu_si256((__m256i*)args, argv);
+    Cost minCost = reduceLanes(mins, args, 4, size, argmin);
+    for (; j < size; j++) {
+        if (mask[j] && base + (Cost)col[(size_t)j * stride] - adj[j] < minCost) {
+            minCost = base + (Cost)col[(size_t)j * stride] - adj[j];
+            argmin = j;
+        }
+    }
+    return minCost;
+}
+
+template <class T>
+__attribute__((target("avx512f"))) static Cost rowMinCostAVX512(const void* row_, Cost base, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin)
+{
+    const T* row = (const T*)row_;
+    const __m512i basev = _mm512_set1_epi64(base);
+    const __m512i step = _mm512_set1_epi64(8);
+    __m512i minv = _mm512_set1_epi64(numeric_limits<Cost>::max());
+    __m512i argv = _mm512_set1_epi64(size);
+    __m512i idx = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    unsigned int j = 0;
+    for (; j + 8 <= size; j += 8) {
+        __m512i m = _mm512_loadu_si512((const void*)(mask + j));
+        __mmask8 present = _mm512_test_epi64_mask(m, m);
+        __m512i cost = _mm512_sub_epi64(_mm512_add_epi64(load8(row + j), basev), _mm512_loadu_si512((const void*)(adj + j)));
+        __mmask8 lt = _mm512_mask_cmplt_epi64_mask(present, cost, minv);
+        minv = _mm512_mask_mov_epi64(minv, lt, cost);
+        argv = _mm512_mask_mov_epi64(argv, lt, idx);
+        idx = _mm512_add_epi64(idx, step);
+    }
+    Cost mins[8], args[8];
+    _mm512_storeu_si512((void*)mins, minv);
+    _mm512_storeu_si512((void*)args, argv);
+    Cost minCost = reduceLanes(mins, args, 8, size, argmin);
+    for (; j < size; j++) {
+        if (mask[j] && base + (Cost)row[j] - adj[j] < minCost) {
+            minCost = base + (Cost)row[j] - adj[j];
+            argmin = j;
+        }
+    }
+    return minCost;
+}
+
+template <class T>
+__attribute__((target("avx512f"))) static Cost columnMinCostAVX512(const void* col_, unsigned int stride, Cost base, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin)
+{
+    const T* col = (const T*)col_;
+    const __m512i basev = _mm512_set1_epi64(base);
+    const __m512i step = _mm512_set1_epi64(8);
+    const __m512i offsetStep = _mm512_set1_epi64(8 * (Long)stride);
+    __m512i minv = _mm512_set1_epi64(numeric_limits<Cost>::max());
+    __m512i argv = _mm512_set1_epi64(size);
+    __m512i idx = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    __m512i offset = _mm512_setr_epi64(0, stride, 2 * (Long)stride, 3 * (Long)stride, 4 * (Long)stride, 5 * (Long)stride, 6 * (Long)stride, 7 * (Long)stride);
+    unsigned int j = 0;
+    for (; j + 8 <= size; j += 8) {
+        __m512i m = _mm512_loadu_si512((const void*)(mask + j));
+        __mmask8 present = _mm512_test_epi64_mask(m, m);
+        __m512i cost = _mm512_sub_epi64(_mm512_add_epi64(gather8(col, offset), basev), _mm512_loadu_si512((const void*)(adj + j)));
+        __mmask8 lt = _mm512_mask_cmplt_epi64_mask(present, cost, minv);
+        minv = _mm512_mask_mov_epi64(minv, lt, cost);
+        argv = _mm512_mask_mov_epi64(argv, lt, idx);
+        idx = _mm512_add_epi64(idx, step);
+        offset = _mm512_add_epi64(offset, offsetStep);
+    }
+    Cost mins[8], args[8];
+    _mm512_storeu_si512((void*)mins, minv);
+    _mm512_storeu_si512((void*)args, argv);
+    Cost minCost = reduceLanes(mins, args, 8, size, argmin);
+    for (; j < size; j++) {
+        if (mask[j] && base + (Cost)col[(size_t)j * stride] - adj[j] < minCost) {
+            minCost = base + (Cost)col[(size_t)j * stride] - adj[j];
+            argmin = j;
+        }
+    }
+    return minCost;
+}
+
+__attribute__((target("avx2"))) static void maxDiffCostAVX2(Cost* diff, Cost ca, const Cost* col, const Cost* mask, unsigned int size)
+{
+    const __m256i cav = _mm256_set1_epi64x(ca);
+    unsigned int j = 0;
+    for (; j + 4 <= size; j += 4) {
+        __m256i d = _mm256_and_si256(_mm256_sub_epi64(cav, _mm256_loadu_si256((const __m256i*)(col + j))), _mm256_loadu_si256((const __m256i*)(mask + j)));
+        __m256i cur = _mm256_loadu_si256((const __m256i*)(diff + j));
+        _mm256_storeu_si256((__m256i*)(diff + j), _mm256_blendv_epi8(cur, d, _mm256_cmpgt_epi64(d, cur)));
+    }
+    maxDiffCostScalar(diff + j, ca, col + j, mask + j, size - j);
+}
+
+__attribute__((target("avx2"))) static void boundedSumCostAVX2(Cost* sum, const Cost* add, Cost cap, unsigned int size)
+{
+    const __m256i capv = _mm256_set1_epi64x(cap);
+    unsigned int j = 0;
+    for (; j + 4 <= size; j += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(add + j));
+        a = _mm256_blendv_epi8(a, capv, _mm256_cmpgt_epi64(a, capv));
+        __m256i t = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(sum + j)), a);
+        _mm256_storeu_si256((__m256i*)(sum + j), _mm256_blendv_epi8(t, capv, _mm256_cmpgt_epi64(t, capv)));
+    }
+    boundedSumCostScalar(sum + j, add + j, cap, size - j);
+}
+
+__attribute__((target("avx512f"))) static void maxDiffCostAVX512(Cost* diff, Cost ca, const Cost* col, const Cost* mask, unsigned int size)
+{
+    const __m512i cav = _mm512_set1_epi64(ca);
+    unsigned int j = 0;
+    for (; j + 8 <= size; j += 8) {
+        __m512i m = _mm512_loadu_si512((const void*)(mask + j));
+        __mmask8 present = _mm512_test_epi64_mask(m, m);
+        __m512i cur = _mm512_loadu_si512((const void*)(diff + j));
+        __m512i d = _mm512_sub_epi64(cav, _mm512_loadu_si512((const void*)(col + j)));
+        _mm512_storeu_si512((void*)(diff + j), _mm512_mask_max_epi64(cur, present, cur, d));
+    }
+    maxDiffCostScalar(diff + j, ca, col + j, mask + j, size - j);
+}
+
+__attribute__((target("avx512f"))) static void boundedSumCostAVX512(Cost* sum, const Cost* add, Cost cap, unsigned int size)
+{
+    const __m512i capv = _mm512_set1_epi64(cap);
+    unsigned int j = 0;
+    for (; j + 8 <= size; j += 8) {
+        __m512i a = _mm512_maskz_min_epi64(0xFF, _mm512_loadu_si512((const void*)(add + j)), capv);
+        _mm512_storeu_si512((void*)(sum + j), _mm512_maskz_min_epi64(0xFF, _mm512_add_epi64(_mm512_loadu_si512((const void*)(sum + j)), a), capv));
+    }
+    boundedSumCostScalar(sum + j, add + j, cap, size - j);
+}
+#endif
+
+RowMinCostKernel rowMinCostKernels[NB_COSTWIDTHS] = { rowMinCostScalar<uint16_t>, rowMinCostScalar<uint32_t>, rowMinCostScalar<Cost> };
+ColumnMinCostKernel columnMinCostKernels[NB_COSTWIDTHS] = { columnMinCostScalar<uint16_t>, columnMinCostScalar<uint32_t>, columnMinCostScalar<Cost> };
+MaxDiffCostKernel maxDiffCostKernel = maxDiffCostScalar;
+BoundedSumCostKernel boundedSumCostKernel = boundedSumCostScalar;
+static int costKernels = COSTKERNELS_SCALAR;
+
+int selectCostKernels(int level)
+{
+    int best = COSTKERNELS_SCALAR;
+#ifdef COSTKERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        best = COSTKERNELS_AVX2;
+    if (__builtin_cpu_supports("avx512f"))
+        best = COSTKERNELS_AVX512;
+#endif
+    if (level < 0 || level > best)
+        level = best;
+    costKernels = level;
+    rowMinCostKernels[COSTWIDTH_16] = rowMinCostScalar<uint16_t>;
+    rowMinCostKernels[COSTWIDTH_32] = rowMinCostScalar<uint32_t>;
+    rowMinCostKernels[COSTWIDTH_PLAIN] = rowMinCostScalar<Cost>;
+    columnMinCostKernels[COSTWIDTH_16] = columnMinCostScalar<uint16_t>;
+    columnMinCostKernels[COSTWIDTH_32] = columnMinCostScalar<uint32_t>;
+    columnMinCostKernels[COSTWIDTH_PLAIN] = columnMinCostScalar<Cost>;
+    maxDiffCostKernel = maxDiffCostScalar;
+    boundedSumCostKernel = boundedSumCostScalar;
+#ifdef COSTKERNELS_X86
+    if (level == COSTKERNELS_AVX2) {
+        rowMinCostKernels[COSTWIDTH_16] = rowMinCostAVX2<uint16_t>;
+        rowMinCostKernels[COSTWIDTH_32] = rowMinCostAVX2<uint32_t>;
+        rowMinCostKernels[COSTWIDTH_PLAIN] = rowMinCostAVX2<Cost>;
+        columnMinCostKernels[COSTWIDTH_16] = columnMinCostAVX2<uint16_t>;
+        columnMinCostKernels[COSTWIDTH_32] = columnMinCostAVX2<uint32_t>;
+        columnMinCostKernels[COSTWIDTH_PLAIN] = columnMinCostAVX2<Cost>;
+        maxDiffCostKernel = maxDiffCostAVX2;
+        boundedSumCostKernel = boundedSumCostAVX2;
+    } else if (level == COSTKERNELS_AVX512) {
+        rowMinCostKernels[COSTWIDTH_16] = rowMinCostAVX512<uint16_t>;
+        rowMinCostKernels[COSTWIDTH_32] = rowMinCostAVX512<uint32_t>;
+        rowMinCostKernels[COSTWIDTH_PLAIN] = rowMinCostAVX512<Cost>;
+        columnMinCostKernels[COSTWIDTH_16] = columnMinCostAVX512<uint16_t>;
+        columnMinCostKernels[COSTWIDTH_32] = columnMinCostAVX512<uint32_t>;
+        columnMinCostKernels[COSTWIDTH_PLAIN] = columnMinCostAVX512<Cost>;
+        maxDiffCostKernel = maxDiffCostAVX512;
+        boundedSumCostKernel = boundedSumCostAVX512;
+    }
+#endif
+    return level;
+}
+
+int getCostKernels()
+{
+    return costKernels;
+}
+
+static int costKernelsInit = selectCostKernels();
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
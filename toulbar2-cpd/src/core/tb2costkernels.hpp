@@ -0,0 +1,79 @@
+/** \file tb2costkernels.hpp
+ *  \brief Dense kernels over rows and columns of cost matrices.
+ *
+ * The minimum kernels compute the minimum of \c (costs[j] - adj[j]) over the indexes \c j such that \c mask[j] is nonzero,
+ * together with the first index reaching it. They work on plain cost arrays, such that the compiler or explicit
+ * AVX2/AVX-512 code can process several costs at once. The instruction set is selected at run time.
+ *
+ * Cost matrices can be encoded on 16 or 32 bits as unsigned offsets from a base cost (see ::CostWidth and ::StoreCostTable),
+ * one kernel being available for each encoding.
+ *
+ * The dead-end elimination kernels update vectors of maximum cost differences and their bounded sums
+ * over all the values of a variable at once (see EnumeratedVariable::computeDEEMatrix).
+ *
+ * \note explicit vector instructions are only used with 64-bit costs (\c LONGLONG_COST) on x86-64, otherwise a portable loop is used
+ */
+
+#ifndef TB2COSTKERNELS_HPP_
+#define TB2COSTKERNELS_HPP_
+
+#include "tb2types.hpp"
+
+enum CostKernels {
+    COSTKERNELS_NONE = 0, ///< do not use dense kernels (iterate over domains)
+    COSTKERNELS_SCALAR = 1, ///< portable loops over cost arrays
+    COSTKERNELS_AVX2 = 2,
+    COSTKERNELS_AVX512 = 3
+};
+
+/// \brief minimum of \c (base + row[j] - adj[j]) for \c j in [0,size) with \c mask[j] != 0
+/// \param row first element of a row encoded with a given ::CostWidth
+/// \param argmin (out) first index reaching the minimum (\a size if the mask is empty)
+/// \return the minimum, or \c numeric_limits<Cost>::max() if the mask is empty
+typedef Cost (*RowMinCostKernel)(const void* row, Cost base, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin);
+
+/// \brief same as ::RowMinCostKernel for a column \c col[j * stride] of a row-major matrix
+typedef Cost (*ColumnMinCostKernel)(const void* col, unsigned int stride, Cost base, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin);
+
+extern RowMinCostKernel rowMinCostKernels[NB_COSTWIDTHS]; ///< indexed by ::CostWidth
+extern ColumnMinCostKernel columnMinCostKernels[NB_COSTWIDTHS]; ///< indexed by ::CostWidth
+
+/// \brief \c diff[j] = max(diff[j], ca - col[j]) for \c j in [0,size) with \c mask[j] equal to -1 (\a mask is either 0 or -1)
+/// \warning assumes \c 0 <= diff[j]
+typedef void (*MaxDiffCostKernel)(Cost* diff, Cost ca, const Cost* col, const Cost* mask, unsigned int size);
+
+/// \brief \c sum[j] = min(sum[j] + add[j], cap) for \c j in [0,size)
+/// \warning assumes \c 0 <= add[j], \c sum[j] <= cap, and \a cap at most half of the largest cost
+typedef void (*BoundedSumCostKernel)(Cost* sum, const Cost* add, Cost cap, unsigned int size);
+
+extern MaxDiffCostKernel maxDiffCostKernel;
+extern BoundedSumCostKernel boundedSumCostKernel;
+
+/// \brief ::RowMinCostKernel over plain costs
+inline Cost rowMinCost(const Cost* row, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin)
+{
+    return rowMinCostKernels[COSTWIDTH_PLAIN](row, MIN_COST, adj, mask, size, argmin);
+}
+
+/// \brief ::ColumnMinCostKernel over plain costs
+inline Cost columnMinCost(const Cost* col, unsigned int stride, const Cost* adj, const Cost* mask, unsigned int size, unsigned int& argmin)
+{
+    return columnMinCostKernels[COSTWIDTH_PLAIN](col, stride, MIN_COST, adj, mask, size, argmin);
+}
+
+/// \brief selects the kernels used by ::rowMinCostKernels, ::columnMinCostKernels, ::maxDiffCostKernel and ::boundedSumCostKernel
+/// \param level one of ::CostKernels, or -1 for the best one supported by the processor
+/// \return the selected level (can be lower than requested if the processor or the cost type does not support it)
+int selectCostKernels(int level = -1);
+
+/// \brief currently selected ::CostKernels level
+int getCostKernels();
+
+#endif /*TB2COSTKERNELS_HPP_*/
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
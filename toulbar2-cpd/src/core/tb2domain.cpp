@@ -13,6 +13,7 @@ Domain::Domain(Value inf, Value sup)
     : BTList<Value>(&Store::storeDomain)
     , initSize(sup - inf + 1)
     , distanceToZero(inf)
+    , bits{ (uint64_t)0, (uint64_t)0 }
 {
     init(inf, sup);
 }
@@ -21,6 +22,7 @@ Domain::Domain(Value* d, int dsize)
     : BTList<Value>(&Store::storeDomain)
     , initSize(max(d, dsize) - min(d, dsize) + 1)
     , distanceToZero(min(d, dsize))
+    , bits{ (uint64_t)0, (uint64_t)0 }
 {
     assert(dsize >= 1);
     assert(dsize <= MAX_DOMAIN_SIZE);
@@ -28,9 +30,11 @@ Domain::Domain(Value* d, int dsize)
     init(d[0], d[dsize - 1]);
     int i = 0;
     for (iterator iter = begin(); iter != end(); ++iter) {
-        if (*iter < d[i])
+        if (*iter < d[i]) {
             BTList<Value>::erase(&all[toIndex(*iter)], false);
-        else
+            if (isBitset())
+                bits[toIndex(*iter) / 64] = (uint64_t)bits[toIndex(*iter) / 64] & ~((uint64_t)1 << (toIndex(*iter) % 64));
+        } else
             i++;
     }
 }
@@ -47,6 +51,10 @@ void Domain::init(Value inf, Value sup)
         all[idx].content = idx + inf;
         push_back(&all[idx], false);
     }
+    if (isBitset()) {
+        for (unsigned int idx = 0; idx < initSize; idx++)
+            bits[idx / 64] = (uint64_t)bits[idx / 64] | ((uint64_t)1 << (idx % 64));
+    }
 }
 
 int cmpValue(const void* v1, const void* v2)
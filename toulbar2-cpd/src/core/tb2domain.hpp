@@ -1,6 +1,8 @@
 /** \file tb2domain.hpp
  *  \brief Storable enumerated domain.
  *
+ *  Small domains (at most Domain::BitsetMaxSize values initially) are also represented by a storable bitset of value indexes,
+ *  giving fast membership tests and masks of the current domain without following the list.
  */
 
 #ifndef TB2DOMAIN_HPP_
@@ -10,10 +12,32 @@
 
 extern int cmpValue(const void* v1, const void* v2);
 
+/// \return position of the lowest bit set in a nonzero \a word
+inline unsigned int lowestBit(uint64_t word)
+{
+    assert(word != 0);
+#ifdef __GNUC__
+    return __builtin_ctzll(word);
+#else
+    unsigned int pos = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        pos++;
+    }
+    return pos;
+#endif
+}
+
 class Domain : public BTList<Value> {
+public:
+    static const unsigned int BitsetMaxSize = 128; ///< maximum initial domain size to also use a bitset
+    static const unsigned int BitsetWords = BitsetMaxSize / 64;
+
+private:
     const unsigned int initSize;
     const Value distanceToZero;
     DLink<Value>* all;
+    StoreWord bits[BitsetWords]; ///< bit \e i of word \e w set if value index 64 * \e w + \e i is in the domain (only if initSize <= BitsetMaxSize)
 
     vector<string> valueNames;
 
@@ -52,10 +76,25 @@ public:
         exit(EXIT_FAILURE);
     }
 
-    bool canbe(Value v) const { return !all[toIndex(v)].removed; }
-    bool cannotbe(Value v) const { return all[toIndex(v)].removed; }
+    bool isBitset() const { return initSize <= BitsetMaxSize; }
+    /// \return word \a w of the bitset of the domain
+    /// \warning only if isBitset()
+    uint64_t getBits(unsigned int w) const { return bits[w]; }
 
-    void erase(Value v) { BTList<Value>::erase(&all[toIndex(v)], true); }
+    bool canbe(Value v) const
+    {
+        unsigned int idx = toIndex(v);
+        return (isBitset()) ? (((uint64_t)bits[idx / 64] >> (idx % 64)) & 1) : !all[idx].removed;
+    }
+    bool cannotbe(Value v) const { return !canbe(v); }
+
+    void erase(Value v)
+    {
+        unsigned int idx = toIndex(v);
+        BTList<Value>::erase(&all[idx], true);
+        if (isBitset())
+            bits[idx / 64] = (uint64_t)bits[idx / 64] & ~((uint64_t)1 << (idx % 64));
+    }
 
     Value increase(Value v)
     {
@@ -526,6 +526,13 @@ void EnumeratedVariable::propagateDEE(Value a, Value b, bool dee)
         if (totaldiffcosta > costb && totaldiffcostb > costa)
             return;
     }
+    pruneDEE(a, b, costa, costb, totalmaxcosta, totalmaxcostb, totaldiffcosta, totaldiffcostb);
+}
+
+/// \brief removes dominated values given the unary costs of \e a and \e b and their sums with maximum costs and maximum cost differences
+/// \note sums greater than the maximum unary cost are only compared to it (they can be bounded)
+void EnumeratedVariable::pruneDEE(Value a, Value b, Cost costa, Cost costb, Cost totalmaxcosta, Cost totalmaxcostb, Cost totaldiffcosta, Cost totaldiffcostb)
+{
     assert((totalmaxcosta >= totaldiffcosta || (totalmaxcosta > getMaxCost() && totaldiffcosta > getMaxCost())));
     assert((totalmaxcostb >= totaldiffcostb || (totalmaxcostb > getMaxCost() && totaldiffcostb > getMaxCost())));
     assert(totaldiffcosta <= costb || totaldiffcostb <= costa);
@@ -577,6 +584,106 @@ void EnumeratedVariable::propagateDEE(Value a, Value b, bool dee)
     }
 }
 
+bool EnumeratedVariable::canUseDEEMatrix()
+{
+    for (ConstraintList::iterator iter = constrs.begin(); iter != constrs.end(); ++iter) {
+        if (!(*iter).constr->isBinary())
+            return false;
+    }
+    return true;
+}
+
+/// \brief computes, for all pairs of values, the sums used by EnumeratedVariable::propagateDEE(Value a, Value b, bool dee)
+/// \note for each binary cost function with \e y and each value of \e y, the costs with the current domain form a column,
+/// its maximum cost differences for all pairs are obtained by a ::maxDiffCostKernel call per value
+/// \note sums are bounded by the maximum unary cost plus one, which does not change the comparisons done by EnumeratedVariable::pruneDEE
+void EnumeratedVariable::computeDEEMatrix(DEEMatrix& m)
+{
+    assert(canUseDEEMatrix());
+    unsigned int size = getDomainSize();
+    m.values.clear();
+    m.position.assign(getDomainInitSize(), size);
+    for (iterator iter = begin(); iter != end(); ++iter) {
+        m.position[toIndex(*iter)] = m.values.size();
+        m.values.push_back(*iter);
+    }
+    m.cap = getMaxCost() + UNIT_COST;
+    m.lb = wcsp->getLb();
+    m.ub = wcsp->getUb();
+    m.domainSizes = size;
+    m.maxCosts.assign(size, MIN_COST);
+    m.diffCosts.assign((size_t)size * size, MIN_COST);
+    vector<Cost> unary(size);
+    for (unsigned int i = 0; i < size; i++)
+        unary[i] = getCost(m.values[i]);
+    vector<Cost> col(size);
+    vector<Cost> mask(size);
+    vector<Cost> maxCosts(size);
+    vector<Cost> diffCosts((size_t)size * size);
+    for (ConstraintList::iterator iter = constrs.begin(); iter != constrs.end(); ++iter) {
+        BinaryConstraint* ctr = (BinaryConstraint*)(*iter).constr;
+        EnumeratedVariable* y = (EnumeratedVariable*)ctr->getVarDiffFrom(this);
+        m.domainSizes += y->getDomainSize();
+        std::fill(maxCosts.begin(), maxCosts.end(), MIN_COST);
+        std::fill(diffCosts.begin(), diffCosts.end(), MIN_COST);
+        for (iterator iterY = y->begin(); iterY != y->end(); ++iterY) {
+            Cost ucosty = y->getCost(*iterY);
+            for (unsigned int i = 0; i < size; i++) {
+                Cost cost = ctr->getCost(this, y, m.values[i], *iterY);
+                col[i] = cost;
+                mask[i] = (CUT(unary[i] + cost + ucosty + m.lb, m.ub)) ? MIN_COST : (Cost)-1;
+                if (cost > maxCosts[i])
+                    maxCosts[i] = cost;
+            }
+            for (unsigned int i = 0; i < size; i++)
+                maxDiffCostKernel(&diffCosts[(size_t)i * size], col[i], &col[0], &mask[0], size);
+        }
+        boundedSumCostKernel(&m.maxCosts[0], &maxCosts[0], m.cap, size);
+        boundedSumCostKernel(&m.diffCosts[0], &diffCosts[0], m.cap, size * size);
+    }
+}
+
+/// \brief checks the matrix has been computed with the current domains, unary and binary costs, up to unary costs projected to the lower bound by this variable
+/// \note during dead-end elimination and node consistency, the other changes come from value removals, lower bound increases, or assignments
+/// \warning assignments of variables which are not neighbors are not detected (the caller must check the number of unassigned variables)
+bool EnumeratedVariable::isDEEMatrixValid(const DEEMatrix& m)
+{
+    if (m.lb != wcsp->getLb() || m.ub != wcsp->getUb() || getMaxCost() >= m.cap)
+        return false;
+    Long domainSizes = getDomainSize();
+    for (ConstraintList::iterator iter = constrs.begin(); iter != constrs.end(); ++iter) {
+        domainSizes += ((BinaryConstraint*)(*iter).constr)->getVarDiffFrom(this)->getDomainSize();
+    }
+    return domainSizes == m.domainSizes;
+}
+
+void EnumeratedVariable::propagateDEE(const DEEMatrix& m)
+{
+    assert(isDEEMatrixValid(m));
+    unsigned int size = m.values.size();
+    for (iterator itera = begin(); itera != end(); ++itera) {
+        for (iterator iterb = lower_bound(*itera + 1); iterb != end(); ++iterb) {
+            assert(canbe(*itera));
+            assert(canbe(*iterb));
+            assert(*itera != *iterb);
+            Value a = *itera;
+            Value b = *iterb;
+            unsigned int i = m.position[toIndex(a)];
+            unsigned int j = m.position[toIndex(b)];
+            assert(i < size && j < size);
+            Cost costa = getCost(a);
+            Cost costb = getCost(b);
+            Cost totaldiffcosta = costa + m.diffCosts[(size_t)i * size + j];
+            Cost totaldiffcostb = costb + m.diffCosts[(size_t)j * size + i];
+            if (totaldiffcosta <= costb || totaldiffcostb <= costa) {
+                pruneDEE(a, b, costa, costb, costa + m.maxCosts[i], costb + m.maxCosts[j], totaldiffcosta, totaldiffcostb);
+                if (cannotbe(a))
+                    break;
+            }
+        }
+    }
+}
+
 bool EnumeratedVariable::verifyDEE(Value a, Value b)
 {
     if (a == b)
@@ -1398,6 +1505,58 @@ bool EnumeratedVariable::canbeMerged(EnumeratedVariable* x)
     return true;
 }
 
+/// \brief finds the values having the same unary cost, the same binary costs with every value of the neighbors and the same amino acid \a aa (if not NULL) as a smaller value,
+/// each of them is returned as a pair (value, smallest interchangeable value)
+/// \note values are grouped by a hash of their costs before being compared, costs greater than the upper bound are all equal to it
+void EnumeratedVariable::findInterchangeableValues(const vector<char>* aa, vector<pair<Value, Value>>& merged)
+{
+    merged.clear();
+    if (getDomainSize() <= 1 || !canUseDEEMatrix())
+        return;
+    Cost ub = wcsp->getUb();
+    auto aminoAcid = [aa](unsigned int idx) { return (aa && idx < aa->size()) ? (*aa)[idx] : '\0'; };
+    auto combine = [](size_t h, Cost c) { return h ^ (std::hash<Cost>()(c) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2)); };
+    vector<pair<size_t, Value>> signatures;
+    for (iterator iter = begin(); iter != end(); ++iter) {
+        size_t h = combine(aminoAcid(toIndex(*iter)), min(getCost(*iter), ub));
+        for (ConstraintList::iterator iterc = constrs.begin(); iterc != constrs.end(); ++iterc) {
+            BinaryConstraint* ctr = (BinaryConstraint*)(*iterc).constr;
+            EnumeratedVariable* y = (EnumeratedVariable*)ctr->getVarDiffFrom(this);
+            for (iterator iterY = y->begin(); iterY != y->end(); ++iterY) {
+                h = combine(h, min(ctr->getCost(this, y, *iter, *iterY), ub));
+            }
+        }
+        signatures.push_back(make_pair(h, *iter));
+    }
+    sort(signatures.begin(), signatures.end());
+    auto interchangeable = [&](Value a, Value b) {
+        if (aminoAcid(toIndex(a)) != aminoAcid(toIndex(b)) || min(getCost(a), ub) != min(getCost(b), ub))
+            return false;
+        for (ConstraintList::iterator iterc = constrs.begin(); iterc != constrs.end(); ++iterc) {
+            BinaryConstraint* ctr = (BinaryConstraint*)(*iterc).constr;
+            EnumeratedVariable* y = (EnumeratedVariable*)ctr->getVarDiffFrom(this);
+            for (iterator iterY = y->begin(); iterY != y->end(); ++iterY) {
+                if (min(ctr->getCost(this, y, a, *iterY), ub) != min(ctr->getCost(this, y, b, *iterY), ub))
+                    return false;
+            }
+        }
+        return true;
+    };
+    vector<Value> representatives; // of the values with the same hash, in increasing order
+    for (unsigned int i = 0; i < signatures.size(); i++) {
+        if (i == 0 || signatures[i].first != signatures[i - 1].first)
+            representatives.clear();
+        Value a = signatures[i].second;
+        unsigned int r = 0;
+        while (r < representatives.size() && !interchangeable(representatives[r], a))
+            r++;
+        if (r < representatives.size())
+            merged.push_back(make_pair(a, representatives[r]));
+        else
+            representatives.push_back(a);
+    }
+}
+
 // only in preprocessing
 void EnumeratedVariable::mergeTo(BinaryConstraint* xy, map<Value, Value>& functional)
 {
@@ -9,6 +9,19 @@
 #include "tb2variable.hpp"
 #include "tb2domain.hpp"
 
+/// \brief bounded sums over the cost functions of a variable of the maximum costs and maximum cost differences used by dead-end elimination
+/// \note filled by EnumeratedVariable::computeDEEMatrix, with the current state of the problem at that time (see EnumeratedVariable::isDEEMatrixValid)
+struct DEEMatrix {
+    vector<Value> values; ///< current domain when computed
+    vector<unsigned int> position; ///< position in \c values of each initial value index
+    vector<Cost> maxCosts; ///< for each value \e a, sum over cost functions of their maximum cost with \e a
+    vector<Cost> diffCosts; ///< for each pair of values (\e a,\e b), sum over cost functions of their maximum cost difference between \e a and \e b (row-major)
+    Cost cap; ///< sums are bounded by this cost
+    Cost lb;
+    Cost ub;
+    Long domainSizes; ///< sum of the domain sizes of the variable and its neighbors
+};
+
 class EnumeratedVariable : public Variable {
 protected:
     Domain domain;
@@ -69,6 +82,24 @@ public:
     void getDomain(Value* array);
     void getDomainAndCost(ValueCost* array);
 
+    /// \brief copies the current domain as a bitset of value indexes (see Domain::getBits)
+    /// \param bits Domain::BitsetWords words
+    /// \return false if the initial domain is too large for a bitset
+    bool getDomainBits(uint64_t* bits) const
+    {
+        if (!domain.isBitset())
+            return false;
+        if (assigned()) {
+            unsigned int idx = toIndex(getValue());
+            for (unsigned int w = 0; w < Domain::BitsetWords; w++)
+                bits[w] = (w == idx / 64) ? ((uint64_t)1 << (idx % 64)) : 0;
+        } else {
+            for (unsigned int w = 0; w < Domain::BitsetWords; w++)
+                bits[w] = domain.getBits(w);
+        }
+        return true;
+    }
+
     bool canbe(Value v) const FINAL { return v >= inf && v <= sup && domain.canbe(v); }
     bool canbeAfterElim(Value v) const { return domain.canbe(v); }
     bool cannotbe(Value v) const FINAL { return v < inf || v > sup || domain.cannotbe(v); }
@@ -126,6 +157,11 @@ public:
 
     void queueDEE();
     void propagateDEE(Value a, Value b, bool dee = true);
+    void pruneDEE(Value a, Value b, Cost costa, Cost costb, Cost totalmaxcosta, Cost totalmaxcostb, Cost totaldiffcosta, Cost totaldiffcostb);
+    bool canUseDEEMatrix(); ///< \return true if all the cost functions are binary
+    void computeDEEMatrix(DEEMatrix& m); ///< \warning only reads the problem, can be called in parallel on different variables
+    bool isDEEMatrixValid(const DEEMatrix& m);
+    void propagateDEE(const DEEMatrix& m); ///< \brief dead-end elimination on all pairs of values from a valid matrix
     bool verifyDEE(Value a, Value b);
     bool verifyDEE();
 
@@ -137,6 +173,7 @@ public:
     // merge current cost functions to x's list by replacing current variable y by x thanks to functional constraint xy (i.e., y := functional[x])
     void mergeTo(BinaryConstraint* xy, map<Value, Value>& functional);
     bool canbeMerged(EnumeratedVariable* x);
+    void findInterchangeableValues(const vector<char>* aa, vector<pair<Value, Value>>& merged); ///< \warning only reads the problem, can be called in parallel on different variables
 
     class iterator;
     friend class iterator;
@@ -196,14 +196,9 @@ Cost NaryConstraint::eval(const String& tin, EnumeratedVariable** scope_in)
 
 Cost NaryConstraint::eval(const String& s)
 {
-    if (pf) {
-        TUPLES& f = *pf;
-        TUPLES::iterator it = f.find(s);
-        if (it != f.end())
-            return it->second;
-        else
-            return default_cost;
-    } else
+    if (pf)
+        return pf->get(s, default_cost);
+    else
         return costs[getCostsIndex(s)];
 }
 
@@ -899,6 +894,163 @@ void NaryConstraint::insertSum(const String& t1, Cost c1, Constraint* ctr1, cons
 //    reconnect();
 //}
 
+// Sum of cost functions in extension (bucket elimination, see WCSP::sumBucket)
+// All the tables are dense, with the last variable of the scope varying fastest, such that the sums are done
+// by the bounded sum kernel over rows of its domain size (see tb2costkernels.hpp)
+// complexity O(|ctrs| * |f|)
+// this function is independent of the search
+void NaryConstraint::sumDense(const vector<Constraint*>& ctrs)
+{
+    assert(costs);
+    assert(ctrs.size() > 0);
+    Cost Top = wcsp->getUb();
+    int a = arity_;
+    int nbctrs = ctrs.size();
+    vector<unsigned int> domsize(a);
+    vector<vector<char>> valid(a); // values in the current domains
+    ptrdiff_t sz = 1;
+    for (int i = 0; i < a; i++) {
+        EnumeratedVariable* var = (EnumeratedVariable*)getVar(i);
+        domsize[i] = var->getDomainInitSize();
+        sz *= domsize[i];
+        valid[i].resize(domsize[i]);
+        for (unsigned int v = 0; v < domsize[i]; v++)
+            valid[i][v] = var->canbe(var->toValue(v));
+    }
+    unsigned int rowsize = domsize[a - 1];
+
+    // dense tables of the cost functions with their variables ordered as in this scope, bounded by Top,
+    // and the strides of the variables of this scope in these tables (zero if not in their scope)
+    vector<vector<Cost>> tables(nbctrs);
+    vector<vector<ptrdiff_t>> strides(nbctrs, vector<ptrdiff_t>(a, 0));
+    for (int k = 0; k < nbctrs; k++) {
+        Constraint* ctr = ctrs[k];
+        vector<int> pos;
+        for (int i = 0; i < a; i++)
+            if (ctr->getIndex(getVar(i)) >= 0)
+                pos.push_back(i);
+        assert((int)pos.size() == ctr->arity());
+        ptrdiff_t base = 1;
+        for (int j = pos.size() - 1; j >= 0; j--) {
+            strides[k][pos[j]] = base;
+            base *= domsize[pos[j]];
+        }
+        tables[k].resize(base);
+        NaryConstraint* nary = (ctr->isNary() && ((NaryConstraint*)ctr)->costs) ? (NaryConstraint*)ctr : NULL;
+        vector<ptrdiff_t> narystrides(pos.size()); // strides of the variables in the table of nary
+        if (nary) {
+            for (unsigned int j = 0; j < pos.size(); j++) {
+                narystrides[j] = 1;
+                for (int l = nary->getIndex(getVar(pos[j])) + 1; l < nary->arity_; l++)
+                    narystrides[j] *= ((EnumeratedVariable*)nary->getVar(l))->getDomainInitSize();
+            }
+        }
+        String t(ctr->arity(), CHAR_FIRST);
+        vector<unsigned int> tuple(pos.size(), 0);
+        ptrdiff_t naryidx = 0;
+        for (ptrdiff_t idx = 0; idx < base; idx++) {
+            if (nary) {
+                tables[k][idx] = min(Top, nary->costs[naryidx]);
+            } else {
+                for (unsigned int j = 0; j < pos.size(); j++)
+                    t[ctr->getIndex(getVar(pos[j]))] = tuple[j] + CHAR_FIRST;
+                tables[k][idx] = min(Top, ctr->evalsubstr(t, ctr));
+            }
+            int j = pos.size() - 1;
+            while (j >= 0 && ++tuple[j] == domsize[pos[j]]) {
+                tuple[j] = 0;
+                naryidx -= narystrides[j] * (domsize[pos[j]] - 1);
+                j--;
+            }
+            if (j >= 0)
+                naryidx += narystrides[j];
+        }
+    }
+
+    vector<Cost> broadcast(rowsize); // row of a cost function not depending on the last variable
+    vector<ptrdiff_t> offsets(nbctrs, 0); // offsets of the current row in the tables
+    vector<unsigned int> tuple(a, 0); // current values of the first variables
+    int nbremoved = 0; // number of first variables with a value not in their current domain
+    for (int i = 0; i < a - 1; i++)
+        if (!valid[i][0])
+            nbremoved++;
+    for (ptrdiff_t row = 0; row < sz; row += rowsize) {
+        Cost* sum = &costs[row];
+        if (nbremoved > 0) {
+            std::fill(sum, sum + rowsize, Top);
+        } else {
+            std::fill(sum, sum + rowsize, MIN_COST);
+            for (int k = 0; k < nbctrs; k++) {
+                const Cost* add = &tables[k][offsets[k]];
+                if (strides[k][a - 1] == 0) {
+                    std::fill(broadcast.begin(), broadcast.end(), *add);
+                    add = &broadcast[0];
+                }
+                boundedSumCostKernel(sum, add, Top, rowsize);
+            }
+            for (unsigned int j = 0; j < rowsize; j++)
+                if (!valid[a - 1][j])
+                    sum[j] = Top;
+        }
+        int i = a - 2;
+        while (i >= 0) {
+            if (!valid[i][tuple[i]])
+                nbremoved--;
+            tuple[i]++;
+            for (int k = 0; k < nbctrs; k++)
+                offsets[k] += strides[k][i];
+            if (tuple[i] == domsize[i]) {
+                tuple[i] = 0;
+                for (int k = 0; k < nbctrs; k++)
+                    offsets[k] -= strides[k][i] * domsize[i];
+            }
+            if (!valid[i][tuple[i]])
+                nbremoved++;
+            if (tuple[i] > 0)
+                break;
+            i--;
+        }
+    }
+}
+
+// Copy of the dense table of a cost function with the same scope (see Constraint::copy)
+// tuples with values not in the current domains get the default cost
+void NaryConstraint::copyDense(NaryConstraint* ctr)
+{
+    assert(costs && ctr->costs);
+    assert(costSize == ctr->costSize);
+    int a = arity_;
+    vector<unsigned int> domsize(a);
+    vector<vector<char>> valid(a);
+    int nbremoved = 0; // number of variables with a value not in their current domain in the current tuple
+    for (int i = 0; i < a; i++) {
+        EnumeratedVariable* var = (EnumeratedVariable*)getVar(i);
+        assert(var == ctr->getVar(i));
+        domsize[i] = var->getDomainInitSize();
+        valid[i].resize(domsize[i]);
+        for (unsigned int v = 0; v < domsize[i]; v++)
+            valid[i][v] = var->canbe(var->toValue(v));
+        if (!valid[i][0])
+            nbremoved++;
+    }
+    vector<unsigned int> t(a, 0);
+    for (ptrdiff_t idx = 0; idx < costSize; idx++) {
+        costs[idx] = (nbremoved > 0) ? default_cost : ctr->costs[idx];
+        int i = a - 1;
+        while (i >= 0) {
+            if (!valid[i][t[i]])
+                nbremoved--;
+            if (++t[i] == domsize[i])
+                t[i] = 0;
+            if (!valid[i][t[i]])
+                nbremoved++;
+            if (t[i] > 0)
+                break;
+            i--;
+        }
+    }
+}
+
 // Projection of variable x of the nary constraint
 // complexity O(2|f|)
 // this function is independent of the search
@@ -919,8 +1071,7 @@ void NaryConstraint::project(EnumeratedVariable* x)
         TUPLES fproj;
         TUPLES::iterator it;
         // First part of the projection: complexity O(|f|) we swap positions between the projected variable and the last variable
-        while (!pf->empty()) {
-            it = pf->begin();
+        for (it = pf->begin(); it != pf->end(); ++it) {
             t = it->first;
             c = it->second;
             assert(x->getDegree() == 1);
@@ -933,8 +1084,8 @@ void NaryConstraint::project(EnumeratedVariable* x)
             tswap[arity_ - 1] = tswap[xindex];
             tswap[xindex] = a;
             fproj[tswap] = c;
-            pf->erase(it);
         }
+        pf->clear();
 
         // Second part of the projection: complexity O(|f|) as the projected variable is in the last position,
         // it is sufficient to look for tuples with the same arity-1 prefix. If there are less than d (domain of
@@ -997,6 +1148,89 @@ void NaryConstraint::project(EnumeratedVariable* x)
             }
         }
 
+    } else if (!ToulBar2::isZ) {
+        // First part of the projection: complexity O(|f|) the table is reordered such that x is the last variable,
+        // as it is done below for the scope, if it is not already the case
+        int a = arity_;
+        unsigned int xsize = x->getDomainInitSize();
+        ptrdiff_t sz = costSize / xsize;
+        vector<unsigned int> domsize(a);
+        for (int i = 0; i < a; i++)
+            domsize[i] = ((EnumeratedVariable*)getVar(i))->getDomainInitSize();
+        vector<int> order(a); // variable of the reordered table at each position (swap of x and the last variable)
+        for (int i = 0; i < a; i++)
+            order[i] = (i == xindex) ? (a - 1) : ((i == a - 1) ? xindex : i);
+        if (xindex < a - 1) {
+            vector<ptrdiff_t> strides(a);
+            ptrdiff_t base = 1;
+            for (int i = a - 1; i >= 0; i--) {
+                strides[order[i]] = base;
+                base *= domsize[order[i]];
+            }
+            Cost* costs_ = new Cost[costSize];
+            vector<unsigned int> t(a, 0);
+            ptrdiff_t idx_ = 0;
+            for (ptrdiff_t idx = 0; idx < costSize; idx++) {
+                costs_[idx_] = costs[idx];
+                int i = a - 1;
+                while (i >= 0 && ++t[i] == domsize[i]) {
+                    t[i] = 0;
+                    idx_ -= strides[i] * (domsize[i] - 1);
+                    i--;
+                }
+                if (i >= 0)
+                    idx_ += strides[i];
+            }
+            delete[] costs;
+            costs = costs_;
+        }
+
+        // Second part of the projection: complexity O(|f|) minimum over contiguous rows of the domain size of x
+        // (see tb2costkernels.hpp) plus its unary costs, tuples with removed values having cost Top
+        vector<Cost> adj(xsize, MIN_COST);
+        vector<Cost> mask(xsize, 0);
+        for (unsigned int v = 0; v < xsize; v++) {
+            Value val = x->toValue(v);
+            if (x->canbe(val)) {
+                adj[v] = -x->getCost(val);
+                mask[v] = 1;
+            }
+        }
+        vector<vector<char>> valid(a - 1);
+        int nbremoved = 0; // number of variables with a value not in their current domain in the current tuple
+        for (int i = 0; i < a - 1; i++) {
+            EnumeratedVariable* var = (EnumeratedVariable*)getVar(order[i]);
+            valid[i].resize(domsize[order[i]]);
+            for (unsigned int v = 0; v < domsize[order[i]]; v++)
+                valid[i][v] = var->canbe(var->toValue(v));
+            if (!valid[i][0])
+                nbremoved++;
+        }
+        Cost* costs_ = new Cost[sz];
+        vector<unsigned int> t(a - 1, 0);
+        for (ptrdiff_t idx_ = 0; idx_ < sz; idx_++) {
+            if (nbremoved > 0) {
+                costs_[idx_] = Top;
+            } else {
+                unsigned int argmin;
+                costs_[idx_] = min(Top, rowMinCost(&costs[idx_ * xsize], &adj[0], &mask[0], xsize, argmin));
+            }
+            int i = a - 2;
+            while (i >= 0) {
+                if (!valid[i][t[i]])
+                    nbremoved--;
+                if (++t[i] == domsize[order[i]])
+                    t[i] = 0;
+                if (!valid[i][t[i]])
+                    nbremoved++;
+                if (t[i] > 0)
+                    break;
+                i--;
+            }
+        }
+        costSize = sz;
+        delete[] costs;
+        costs = costs_;
     } else {
         ptrdiff_t sz = costSize / x->getDomainInitSize();
         Cost* costs_ = new Cost[sz];
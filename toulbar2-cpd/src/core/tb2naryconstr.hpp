@@ -5,9 +5,10 @@
 #include "tb2ternaryconstr.hpp"
 #include "tb2enumvar.hpp"
 #include "tb2wcsp.hpp"
+#include "utils/tb2tupletable.hpp"
 
 class NaryConstraint : public AbstractNaryConstraint {
-    typedef map<String, Cost> TUPLES;
+    typedef TupleTable TUPLES;
     TUPLES* pf;
     Cost* costs;
     ptrdiff_t costSize;
@@ -72,11 +73,12 @@ public:
         return index;
     }
     Long size() const FINAL { return (Long)(pf) ? pf->size() : ((costs) ? costSize : 0); }
-    Long space() const FINAL { return ((pf) ? ((Long)pf->size() * (sizeof(Cost) + arity_ * sizeof(Char))) : ((costs) ? ((Long)costSize * sizeof(Cost)) : 0)); } // actual memory space (not taking into account map space overhead)
+    Long space() const FINAL { return ((pf) ? (Long)pf->memory() : ((costs) ? ((Long)costSize * sizeof(Cost)) : 0)); } // actual memory space (including the hash table of the tuples)
     Long space(Long nbtuples) const { return (nbtuples < LONGLONG_MAX / ((Long)(sizeof(Cost) + arity_ * sizeof(Char)))) ? (nbtuples * (sizeof(Cost) + arity_ * sizeof(Char))) : LONGLONG_MAX; } // putative memory space
-    bool expandtodo() { return space() > getDomainInitSizeProduct(); } // should be getDomainInitSizeProduct() * sizeof(Cost) ?
+    bool expandtodo() { return space(size()) > getDomainInitSizeProduct(); } // should be getDomainInitSizeProduct() * sizeof(Cost) ?
     bool expandtodo(Long nbtuples) { return space(nbtuples) > getDomainInitSizeProduct(); } // getDomainInitSizeProduct() * sizeof(Cost) ?
     void expand();
+    bool dense() const { return costs != NULL; } ///< \brief true if the costs are in a table indexed by all the tuples (see NaryConstraint::getCostsIndex)
 
     bool consistent(const String& t);
     Cost eval(const String& s);
@@ -121,6 +123,8 @@ public:
     void fillFilters();
 
     void project(EnumeratedVariable* x);
+    void sumDense(const vector<Constraint*>& ctrs);
+    void copyDense(NaryConstraint* ctr);
     //    void sum( NaryConstraint* nary );
     double computeTightness();
 
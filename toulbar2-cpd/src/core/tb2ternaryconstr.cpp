@@ -19,7 +19,9 @@ TernaryConstraint::TernaryConstraint(WCSP* wcsp,
     BinaryConstraint* xy_,
     BinaryConstraint* xz_,
     BinaryConstraint* yz_,
-    vector<Cost>& tab)
+    vector<Cost>& tab,
+    bool sparseTable,
+    Cost mode)
     : AbstractTernaryConstraint<EnumeratedVariable, EnumeratedVariable, EnumeratedVariable>(wcsp, xx, yy, zz)
     , sizeX(xx->getDomainInitSize())
     , sizeY(yy->getDomainInitSize())
@@ -28,11 +30,13 @@ TernaryConstraint::TernaryConstraint(WCSP* wcsp,
     , functionalX(true)
     , functionalY(true)
     , functionalZ(true)
+    , sparse(0)
+    , defaultCost(MIN_COST)
 {
     assert(tab.size() == sizeX * sizeY * sizeZ);
-    deltaCostsX = vector<StoreCost>(sizeX, StoreCost(MIN_COST));
-    deltaCostsY = vector<StoreCost>(sizeY, StoreCost(MIN_COST));
-    deltaCostsZ = vector<StoreCost>(sizeZ, StoreCost(MIN_COST));
+    deltaCostsX = StoreCostArray(sizeX, MIN_COST);
+    deltaCostsY = StoreCostArray(sizeY, MIN_COST);
+    deltaCostsZ = StoreCostArray(sizeZ, MIN_COST);
     assert(getIndex(x) < getIndex(y) && getIndex(y) < getIndex(z));
     functionX = vector<Value>(sizeY * sizeZ, WRONG_VAL);
     functionY = vector<Value>(sizeX * sizeZ, WRONG_VAL);
@@ -77,7 +81,7 @@ TernaryConstraint::TernaryConstraint(WCSP* wcsp,
     yz = yz_;
 
     if (functionalX) {
-        costsYZ = vector<StoreCost>(sizeY * sizeZ, StoreCost(MIN_COST));
+        costsYZ = StoreCostArray(sizeY * sizeZ, MIN_COST);
         for (unsigned int b = 0; b < y->getDomainInitSize(); b++) {
             for (unsigned int c = 0; c < z->getDomainInitSize(); c++) {
                 if (functionX[b * sizeZ + c] != WRONG_VAL)
@@ -85,8 +89,10 @@ TernaryConstraint::TernaryConstraint(WCSP* wcsp,
             }
         }
         //    	costs.free_all();
+    } else if (sparseTable) {
+        sparsify(tab, mode);
     } else {
-        costs = vector<StoreCost>(sizeX * sizeY * sizeZ, StoreCost(MIN_COST));
+        costs = StoreCostArray(sizeX * sizeY * sizeZ, MIN_COST);
         for (unsigned int a = 0; a < x->getDomainInitSize(); a++) {
             for (unsigned int b = 0; b < y->getDomainInitSize(); b++) {
                 for (unsigned int c = 0; c < z->getDomainInitSize(); c++) {
@@ -191,6 +197,8 @@ TernaryConstraint::TernaryConstraint(WCSP* wcsp)
     , functionalX(false)
     , functionalY(false)
     , functionalZ(false)
+    , sparse(0)
+    , defaultCost(MIN_COST)
 {
     //	unsigned int maxdom = wcsp->getMaxDomainSize();
     //    deltaCostsX = vector<StoreCost>(maxdom,StoreCost(MIN_COST,storeCost));
@@ -213,6 +221,193 @@ TernaryConstraint::TernaryConstraint(WCSP* wcsp)
     yz = NULL;
 }
 
+/// \brief decides whether a ternary table should be stored sparsely (see ToulBar2::sparseTernaryDensity)
+/// \param defaultCost (out) most frequent cost of the table, not stored if sparse
+/// \note tables are only made sparse at the root node (their structure is not restored on backtrack) and if they are large enough
+bool TernaryConstraint::sparseStorage(const vector<Cost>& tab, Cost& defaultCost)
+{
+    if (ToulBar2::sparseTernaryDensity <= 0. || Store::getDepth() > 0 || tab.size() < CompactTableMinSize)
+        return false;
+    size_t modeCount = 0;
+    if (ToulBar2::sparseTernaryDensity < 0.5) {
+        // the most frequent cost of a sparse enough table is a strict majority, found by Boyer-Moore majority vote
+        size_t votes = 0;
+        for (size_t i = 0; i < tab.size(); i++) {
+            if (votes == 0)
+                defaultCost = tab[i];
+            if (tab[i] == defaultCost)
+                votes++;
+            else
+                votes--;
+        }
+        modeCount = count(tab.begin(), tab.end(), defaultCost);
+    } else {
+        vector<Cost> sorted(tab);
+        sort(sorted.begin(), sorted.end());
+        for (size_t i = 0, count = 0; i < sorted.size(); i++) {
+            count = (i > 0 && sorted[i] == sorted[i - 1]) ? count + 1 : 1;
+            if (count > modeCount) {
+                modeCount = count;
+                defaultCost = sorted[i];
+            }
+        }
+    }
+    return (double)(tab.size() - modeCount) <= ToulBar2::sparseTernaryDensity * tab.size();
+}
+
+/// \brief stores the table sparsely or densely depending on its current costs (see sparseStorage)
+void TernaryConstraint::selectStorage()
+{
+    if (functionalX || ToulBar2::sparseTernaryDensity <= 0. || Store::getDepth() > 0)
+        return;
+    vector<Cost> tab((size_t)sizeX * sizeY * sizeZ);
+    for (size_t t = 0; t < tab.size(); t++)
+        tab[t] = tableCost(t);
+    Cost mode = MIN_COST;
+    if (sparseStorage(tab, mode))
+        sparsify(tab, mode);
+    else if (sparse)
+        densify();
+}
+
+/// \brief stores only the tuples whose cost differs from \a mode
+void TernaryConstraint::sparsify(const vector<Cost>& tab, Cost mode)
+{
+    size_t size = (size_t)sizeX * sizeY * sizeZ;
+    assert(tab.size() >= size);
+    defaultCost = mode;
+    sparseBits.assign((size + 63) / 64, 0);
+    sparseRanks.assign(sparseBits.size(), 0);
+    sparseTuples.clear();
+    vector<Cost> values;
+    for (size_t t = 0; t < size; t++) {
+        if (t % 64 == 0)
+            sparseRanks[t / 64] = sparseTuples.size();
+        if (tab[t] != defaultCost) {
+            sparseBits[t / 64] |= (uint64_t)1 << (t % 64);
+            sparseTuples.push_back(t);
+            values.push_back(tab[t]);
+        }
+    }
+    unsigned int sizes[3] = { sizeX, sizeY, sizeZ };
+    size_t strides[3] = { (size_t)sizeY * sizeZ, sizeZ, 1 };
+    for (int k = 0; k < 3; k++) {
+        sparseStarts[k].assign(sizes[k] + 1, 0);
+        for (unsigned int p = 0; p < sparseTuples.size(); p++)
+            sparseStarts[k][(sparseTuples[p] / strides[k]) % sizes[k] + 1]++;
+        for (unsigned int a = 0; a < sizes[k]; a++)
+            sparseStarts[k][a + 1] += sparseStarts[k][a];
+        if (k == 0)
+            continue; // stored tuples are already grouped by value of x
+        sparseLists[k].resize(sparseTuples.size());
+        vector<unsigned int> next(sparseStarts[k].begin(), sparseStarts[k].end() - 1);
+        for (unsigned int p = 0; p < sparseTuples.size(); p++)
+            sparseLists[k][next[(sparseTuples[p] / strides[k]) % sizes[k]]++] = p;
+    }
+    costs.assign(values);
+    sparse = 1;
+}
+
+/// \brief goes back to a dense table (restored on backtrack)
+void TernaryConstraint::densify()
+{
+    assert(sparse);
+    vector<Cost> dense((size_t)sizeX * sizeY * sizeZ, defaultCost);
+    for (size_t p = 0; p < sparseTuples.size(); p++)
+        dense[sparseTuples[p]] = costs[p];
+    costs.assign(dense);
+    sparse = 0;
+}
+
+Cost TernaryConstraint::sparseTableCost(size_t t) const
+{
+    ptrdiff_t pos = sparseIndex(t);
+    return (pos >= 0) ? costs[pos] : defaultCost;
+}
+
+/// \brief modifies a cost of a sparse table, going back to a dense table if a tuple not stored gets a new cost
+void TernaryConstraint::setSparseTableCost(size_t t, Cost c)
+{
+    ptrdiff_t pos = sparseIndex(t);
+    if (pos >= 0) {
+        costs[pos] = c;
+        return;
+    }
+    if (c == defaultCost)
+        return;
+    densify();
+    costs[t] = c;
+}
+
+/// \brief fills sparseOrder with the current domains of the two other variables than \a varIndex (in scope order) by decreasing deltaCosts
+void TernaryConstraint::prepareSparseOrder(int varIndex)
+{
+    EnumeratedVariable* vars[3] = { x, y, z };
+    StoreCostArray* deltas[3] = { &deltaCostsX, &deltaCostsY, &deltaCostsZ };
+    for (int k = 0, o = 0; k < 3; k++) {
+        if (k == varIndex)
+            continue;
+        vector<unsigned int>& order = sparseOrder[o++];
+        const StoreCostArray& delta = *deltas[k];
+        order.clear();
+        for (EnumeratedVariable::iterator iter = vars[k]->begin(); iter != vars[k]->end(); ++iter)
+            order.push_back(vars[k]->toIndex(*iter));
+        stable_sort(order.begin(), order.end(), [&delta](unsigned int a, unsigned int b) { return delta[a] > delta[b]; });
+    }
+}
+
+/// \brief minimum over the current domains of the costs of the tuples with value index \a xindex for the variable \a varIndex of the scope
+/// \param yindex, zindex (out) value indexes of the two other variables (in scope order) reaching the minimum
+/// \note only the stored tuples with this value are visited, plus the first tuples not stored in the order of sparseOrder (see prepareSparseOrder), which give the minimum over the tuples costing defaultCost
+Cost TernaryConstraint::sparseMinCost(int varIndex, unsigned int xindex, unsigned int& yindex, unsigned int& zindex)
+{
+    EnumeratedVariable* vars[3] = { x, y, z };
+    StoreCostArray* deltas[3] = { &deltaCostsX, &deltaCostsY, &deltaCostsZ };
+    unsigned int sizes[3] = { sizeX, sizeY, sizeZ };
+    size_t strides[3] = { (size_t)sizeY * sizeZ, sizeZ, 1 };
+    int o1 = (varIndex == 0) ? 1 : 0;
+    int o2 = (varIndex == 2) ? 1 : 2;
+    const StoreCostArray& delta1 = *deltas[o1];
+    const StoreCostArray& delta2 = *deltas[o2];
+    Cost minCost = MAX_COST;
+    for (unsigned int k = sparseStarts[varIndex][xindex]; k < sparseStarts[varIndex][xindex + 1]; k++) {
+        unsigned int p = (varIndex == 0) ? k : sparseLists[varIndex][k];
+        unsigned int i1 = (sparseTuples[p] / strides[o1]) % sizes[o1];
+        unsigned int i2 = (sparseTuples[p] / strides[o2]) % sizes[o2];
+        if (vars[o1]->canbe(vars[o1]->toValue(i1)) && vars[o2]->canbe(vars[o2]->toValue(i2))) {
+            Cost cost = costs[p] - delta1[i1] - delta2[i2];
+            if (cost < minCost) {
+                minCost = cost;
+                yindex = i1;
+                zindex = i2;
+            }
+        }
+    }
+    const vector<unsigned int>& order1 = sparseOrder[0];
+    const vector<unsigned int>& order2 = sparseOrder[1];
+    Cost maxDelta2 = delta2[order2[0]];
+    for (unsigned int k1 = 0; k1 < order1.size(); k1++) {
+        unsigned int i1 = order1[k1];
+        if (defaultCost - delta1[i1] - maxDelta2 >= minCost)
+            break;
+        size_t t = xindex * strides[varIndex] + i1 * strides[o1];
+        for (unsigned int k2 = 0; k2 < order2.size(); k2++) {
+            unsigned int i2 = order2[k2];
+            if (!sparseStored(t + i2 * strides[o2])) {
+                Cost cost = defaultCost - delta1[i1] - delta2[i2];
+                if (cost < minCost) {
+                    minCost = cost;
+                    yindex = i1;
+                    zindex = i2;
+                }
+                break;
+            }
+        }
+    }
+    assert(minCost < MAX_COST);
+    return minCost - (*deltas[varIndex])[xindex];
+}
+
 double TernaryConstraint::computeTightness()
 {
     int count = 0;
@@ -280,7 +475,7 @@ void TernaryConstraint::dump(ostream& os, bool original)
  * Propagation methods
  *
  */
-bool TernaryConstraint::project(EnumeratedVariable* x, Value value, Cost cost, vector<StoreCost>& deltaCostsX)
+bool TernaryConstraint::project(EnumeratedVariable* x, Value value, Cost cost, StoreCostArray& deltaCostsX)
 {
     assert(ToulBar2::verbose < 4 || ((cout << "project(C" << getVar(0)->getName() << "," << getVar(1)->getName() << "," << getVar(2)->getName() << ", (" << x->getName() << "," << value << "), " << cost << ")" << endl), true));
 
@@ -302,7 +497,7 @@ bool TernaryConstraint::project(EnumeratedVariable* x, Value value, Cost cost, v
     return (x->getSupport() == value || SUPPORTTEST(oldcost, cost));
 }
 
-void TernaryConstraint::extend(EnumeratedVariable* x, Value value, Cost cost, vector<StoreCost>& deltaCostsX)
+void TernaryConstraint::extend(EnumeratedVariable* x, Value value, Cost cost, StoreCostArray& deltaCostsX)
 {
     assert(ToulBar2::verbose < 4 || ((cout << "extend(C" << getVar(0)->getName() << "," << getVar(1)->getName() << "," << getVar(2)->getName() << ", (" << x->getName() << "," << value << "), " << cost << ")" << endl), true));
     TreeDecomposition* td = wcsp->getTreeDec();
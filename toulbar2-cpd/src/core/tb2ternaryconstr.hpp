@@ -211,10 +211,10 @@ protected:
     unsigned int sizeX;
     unsigned int sizeY;
     unsigned int sizeZ;
-    vector<StoreCost> costs;
-    vector<StoreCost> deltaCostsX;
-    vector<StoreCost> deltaCostsY;
-    vector<StoreCost> deltaCostsZ;
+    StoreCostArray costs; ///< row-major table of sizeX * sizeY * sizeZ costs, or costs of the stored tuples if sparse (empty if functionalX)
+    StoreCostArray deltaCostsX;
+    StoreCostArray deltaCostsY;
+    StoreCostArray deltaCostsZ;
     Cost top;
     bool functionalX;
     vector<Value> functionX;
@@ -225,15 +225,55 @@ protected:
     vector<pair<Value, Value>> supportX;
     vector<pair<Value, Value>> supportY;
     vector<pair<Value, Value>> supportZ;
-    vector<StoreCost> costsYZ;
+    StoreCostArray costsYZ;
+
+    StoreInt sparse; ///< if nonzero, only the tuples of sparseBits are stored (in row-major order), the other ones cost defaultCost
+    Cost defaultCost;
+    vector<uint64_t> sparseBits; ///< one bit per tuple in row-major order (set if stored)
+    vector<unsigned int> sparseRanks; ///< number of stored tuples before each word of sparseBits
+    vector<unsigned int> sparseTuples; ///< row-major index of each stored tuple
+    vector<unsigned int> sparseStarts[3]; ///< for each variable of the scope and each of its value indexes, position in sparseLists of its first stored tuple (initial domain size + 1 elements)
+    vector<unsigned int> sparseLists[3]; ///< positions in costs of the stored tuples grouped by value of each variable of the scope (not used for x whose stored tuples are already grouped)
+    vector<unsigned int> sparseOrder[2]; ///< indexes of the current domains of the two other variables by decreasing deltaCosts, see sparseMinCost
+
+    size_t tupleIndex(unsigned int ix, unsigned int iy, unsigned int iz) const { return ((size_t)ix * sizeY + iy) * sizeZ + iz; }
+    bool sparseStored(size_t t) const { return (sparseBits[t / 64] >> (t % 64)) & 1; }
+    /// \return position in costs of a stored tuple, or -1 if it costs defaultCost
+    ptrdiff_t sparseIndex(size_t t) const
+    {
+        uint64_t word = sparseBits[t / 64];
+        uint64_t bit = (uint64_t)1 << (t % 64);
+        if (!(word & bit))
+            return -1;
+        return sparseRanks[t / 64] + bitset<64>(word & (bit - 1)).count();
+    }
+    Cost sparseTableCost(size_t t) const;
+    void setSparseTableCost(size_t t, Cost c);
+    Cost tableCost(size_t t) const { return (sparse) ? sparseTableCost(t) : costs[t]; }
+    void setTableCost(size_t t, Cost c)
+    {
+        if (sparse)
+            setSparseTableCost(t, c);
+        else
+            costs[t] = c;
+    }
+    void addTableCost(size_t t, Cost c)
+    {
+        if (c != MIN_COST)
+            setTableCost(t, tableCost(t) + c);
+    }
+    void sparsify(const vector<Cost>& tab, Cost mode);
+    void densify();
+    void prepareSparseOrder(int varIndex);
+    Cost sparseMinCost(int varIndex, unsigned int xindex, unsigned int& yindex, unsigned int& zindex);
 
     inline Value getFunctionX(Value vy, Value vz) const { return functionX[y->toIndex(vy) * sizeZ + z->toIndex(vz)]; }
     inline Value getFunctionY(Value vx, Value vz) const { return functionY[x->toIndex(vx) * sizeZ + z->toIndex(vz)]; }
     inline Value getFunctionZ(Value vx, Value vy) const { return functionZ[x->toIndex(vx) * sizeY + y->toIndex(vy)]; }
 
     // return true if unary support of x is broken
-    bool project(EnumeratedVariable* x, Value value, Cost cost, vector<StoreCost>& deltaCostsX);
-    void extend(EnumeratedVariable* x, Value value, Cost cost, vector<StoreCost>& deltaCostsX);
+    bool project(EnumeratedVariable* x, Value value, Cost cost, StoreCostArray& deltaCostsX);
+    void extend(EnumeratedVariable* x, Value value, Cost cost, StoreCostArray& deltaCostsX);
 
     template <typename T1, typename T2, typename T3>
     void project(T1 getCost, T2 addCost, bool functionalZ, T3 getFunctionZ, BinaryConstraint* xy, EnumeratedVariable* x, EnumeratedVariable* y, EnumeratedVariable* z, Value valx, Value valy, Cost cost);
@@ -244,15 +284,15 @@ protected:
     void findSupport(T1 getCost, bool functionalY, T2 getFunctionY, bool functionalZ, T3 getFunctionZ,
         EnumeratedVariable* x, EnumeratedVariable* y, EnumeratedVariable* z,
         int getIndexX, int getIndexY, int getIndexZ,
-        vector<pair<Value, Value>>& supportX, vector<StoreCost>& deltaCostsX,
+        vector<pair<Value, Value>>& supportX, StoreCostArray& deltaCostsX,
         vector<pair<Value, Value>>& supportY, vector<pair<Value, Value>>& supportZ);
     template <typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9, typename T10>
     void findFullSupport(T1 getCost, T2 getCostXZY, T3 getCostYZX, T4 getCostWithBinaries, T5 addCost, T6 addCostXZY, T7 addCostYZX, bool functionalX, T8 getFunctionX, bool functionalY, T9 getFunctionY, bool functionalZ, T10 getFunctionZ,
         EnumeratedVariable* x, EnumeratedVariable* y, EnumeratedVariable* z,
         int getIndexX, int getIndexY, int getIndexZ,
-        vector<pair<Value, Value>>& supportX, vector<StoreCost>& deltaCostsX,
-        vector<pair<Value, Value>>& supportY, vector<StoreCost>& deltaCostsY,
-        vector<pair<Value, Value>>& supportZ, vector<StoreCost>& deltaCostsZ,
+        vector<pair<Value, Value>>& supportX, StoreCostArray& deltaCostsX,
+        vector<pair<Value, Value>>& supportY, StoreCostArray& deltaCostsY,
+        vector<pair<Value, Value>>& supportZ, StoreCostArray& deltaCostsZ,
         BinaryConstraint* xy, BinaryConstraint* xz, BinaryConstraint* yz);
     bool verify(EnumeratedVariable* x, EnumeratedVariable* y, EnumeratedVariable* z);
 
@@ -297,10 +337,16 @@ public:
         BinaryConstraint* xy,
         BinaryConstraint* xz,
         BinaryConstraint* yz,
-        vector<Cost>& tab);
+        vector<Cost>& tab,
+        bool sparseTable = false,
+        Cost mode = MIN_COST);
 
     TernaryConstraint(WCSP* wcsp);
 
+    static const unsigned int CompactTableMinSize = 4096; ///< minimum number of tuples to store a table sparsely
+    static bool sparseStorage(const vector<Cost>& tab, Cost& defaultCost);
+    void selectStorage();
+
     void setBinaries(BinaryConstraint* xyin, BinaryConstraint* xzin, BinaryConstraint* yzin)
     {
         xy = xyin;
@@ -322,7 +368,7 @@ public:
         unsigned int ix = x->toIndex(vx);
         unsigned int iy = y->toIndex(vy);
         unsigned int iz = z->toIndex(vz);
-        Cost res = ((costs.empty()) ? ((vx == functionX[iy * sizeZ + iz]) ? (costsYZ[iy * sizeZ + iz] - deltaCostsX[ix] - deltaCostsY[iy] - deltaCostsZ[iz]) : top) : (costs[ix * sizeY * sizeZ + iy * sizeZ + iz] - deltaCostsX[ix] - deltaCostsY[iy] - deltaCostsZ[iz]));
+        Cost res = ((functionalX) ? ((vx == functionX[iy * sizeZ + iz]) ? (costsYZ[iy * sizeZ + iz] - deltaCostsX[ix] - deltaCostsY[iy] - deltaCostsZ[iz]) : top) : (tableCost(tupleIndex(ix, iy, iz)) - deltaCostsX[ix] - deltaCostsY[iy] - deltaCostsZ[iz]));
         assert(res >= MIN_COST);
         return res;
     }
@@ -333,7 +379,7 @@ public:
         vindex[getIndex(xx)] = xx->toIndex(vx);
         vindex[getIndex(yy)] = yy->toIndex(vy);
         vindex[getIndex(zz)] = zz->toIndex(vz);
-        Cost res = ((costs.empty()) ? ((x->toValue(vindex[0]) == functionX[vindex[1] * sizeZ + vindex[2]]) ? (costsYZ[vindex[1] * sizeZ + vindex[2]] - deltaCostsX[vindex[0]] - deltaCostsY[vindex[1]] - deltaCostsZ[vindex[2]]) : top) : (costs[vindex[0] * sizeY * sizeZ + vindex[1] * sizeZ + vindex[2]] - deltaCostsX[vindex[0]] - deltaCostsY[vindex[1]] - deltaCostsZ[vindex[2]]));
+        Cost res = ((functionalX) ? ((x->toValue(vindex[0]) == functionX[vindex[1] * sizeZ + vindex[2]]) ? (costsYZ[vindex[1] * sizeZ + vindex[2]] - deltaCostsX[vindex[0]] - deltaCostsY[vindex[1]] - deltaCostsZ[vindex[2]]) : top) : (tableCost(tupleIndex(vindex[0], vindex[1], vindex[2])) - deltaCostsX[vindex[0]] - deltaCostsY[vindex[1]] - deltaCostsZ[vindex[2]]));
         assert(res >= MIN_COST);
         return res;
     }
@@ -351,7 +397,7 @@ public:
         unsigned int ix = x->toIndex(vx);
         unsigned int iy = y->toIndex(vy);
         unsigned int iz = z->toIndex(vz);
-        Cost res = ((costs.empty()) ? ((vx == functionX[iy * sizeZ + iz]) ? (costsYZ[iy * sizeZ + iz] - deltaCostsX[ix] - deltaCostsY[iy] - deltaCostsZ[iz]) : top) : (costs[ix * sizeY * sizeZ + iy * sizeZ + iz] - deltaCostsX[ix] - deltaCostsY[iy] - deltaCostsZ[iz]));
+        Cost res = ((functionalX) ? ((vx == functionX[iy * sizeZ + iz]) ? (costsYZ[iy * sizeZ + iz] - deltaCostsX[ix] - deltaCostsY[iy] - deltaCostsZ[iz]) : top) : (tableCost(tupleIndex(ix, iy, iz)) - deltaCostsX[ix] - deltaCostsY[iy] - deltaCostsZ[iz]));
         if (xy->connected())
             res += xy->getCost(x, y, vx, vy);
         if (xz->connected())
@@ -368,7 +414,7 @@ public:
         vindex[getIndex(xx)] = pair<unsigned int, Value>(xx->toIndex(vx), vx);
         vindex[getIndex(yy)] = pair<unsigned int, Value>(yy->toIndex(vy), vy);
         vindex[getIndex(zz)] = pair<unsigned int, Value>(zz->toIndex(vz), vz);
-        Cost res = ((costs.empty()) ? ((vindex[0].second == functionX[vindex[1].first * sizeZ + vindex[2].first]) ? (costsYZ[vindex[1].first * sizeZ + vindex[2].first] - deltaCostsX[vindex[0].first] - deltaCostsY[vindex[1].first] - deltaCostsZ[vindex[2].first]) : top) : (costs[vindex[0].first * sizeY * sizeZ + vindex[1].first * sizeZ + vindex[2].first] - deltaCostsX[vindex[0].first] - deltaCostsY[vindex[1].first] - deltaCostsZ[vindex[2].first]));
+        Cost res = ((functionalX) ? ((vindex[0].second == functionX[vindex[1].first * sizeZ + vindex[2].first]) ? (costsYZ[vindex[1].first * sizeZ + vindex[2].first] - deltaCostsX[vindex[0].first] - deltaCostsY[vindex[1].first] - deltaCostsZ[vindex[2].first]) : top) : (tableCost(tupleIndex(vindex[0].first, vindex[1].first, vindex[2].first)) - deltaCostsX[vindex[0].first] - deltaCostsY[vindex[1].first] - deltaCostsZ[vindex[2].first]));
         if (xy->connected())
             res += xy->getCost(x, y, vindex[0].second, vindex[1].second);
         if (xz->connected())
@@ -389,11 +435,11 @@ public:
                     iy = y->toIndex(*itery);
                     iz = z->toIndex(*iterz);
                     // if(costs[ix*sizeY*sizeZ + iy*sizeZ + iz] < wcsp->getUb()) // BUG with BTD (local ub, deltaCosts missing)
-                    if (costs.empty()) {
+                    if (functionalX) {
                         if (*iterx == functionX[iy * sizeZ + iz])
                             costsYZ[iy * sizeZ + iz] += xyz->getCost(x, y, z, *iterx, *itery, *iterz);
                     } else
-                        costs[ix * sizeY * sizeZ + iy * sizeZ + iz] += xyz->getCost(x, y, z, *iterx, *itery, *iterz);
+                        addTableCost(tupleIndex(ix, iy, iz), xyz->getCost(x, y, z, *iterx, *itery, *iterz));
                 }
             }
         }
@@ -401,7 +447,7 @@ public:
 
     void addCosts(EnumeratedVariable* xin, EnumeratedVariable* yin, EnumeratedVariable* zin, vector<Cost>& costsin)
     {
-        assert(costsin.size() <= costs.size() || functionalX);
+        assert(costsin.size() <= (size_t)sizeX * sizeY * sizeZ);
 
         unsigned int vindex[3];
         unsigned int sizeYin = yin->getDomainInitSize();
@@ -420,11 +466,11 @@ public:
                     vindex[getIndex(zin)] = vzin;
 
                     // if(costs[vindex[0]*sizeY*sizeZ + vindex[1]*sizeZ + vindex[2]]  < wcsp->getUb()) // BUG with BTD (local ub, deltaCosts missing)
-                    if (costs.empty()) {
+                    if (functionalX) {
                         if (x->toValue(vindex[0]) == functionX[vindex[1] * sizeZ + vindex[2]])
                             costsYZ[vindex[1] * sizeZ + vindex[2]] += costsin[vxin * sizeYin * sizeZin + vyin * sizeZin + vzin];
                     } else
-                        costs[vindex[0] * sizeY * sizeZ + vindex[1] * sizeZ + vindex[2]] += costsin[vxin * sizeYin * sizeZin + vyin * sizeZin + vzin];
+                        addTableCost(tupleIndex(vindex[0], vindex[1], vindex[2]), costsin[vxin * sizeYin * sizeZin + vyin * sizeZin + vzin]);
                 }
             }
         }
@@ -436,16 +482,16 @@ public:
         unsigned int vx = x->toIndex(vxi);
         unsigned int vy = y->toIndex(vyi);
         unsigned int vz = z->toIndex(vzi);
-        if (costs.empty()) {
+        if (functionalX) {
             if (vxi == functionX[vy * sizeZ + vz])
                 costsYZ[vy * sizeZ + vz] += c;
         } else {
             if (c < MIN_COST && (functionalX || functionalY || functionalZ)) {
                 if ((!functionalX || getFunctionX(vyi, vzi) == vxi) && (!functionalY || getFunctionY(vxi, vzi) == vyi) && (!functionalZ || getFunctionZ(vxi, vyi) == vzi)) {
-                    costs[vx * sizeY * sizeZ + vy * sizeZ + vz] += c; // does not subtract infinity if known by a functional constraint
+                    addTableCost(tupleIndex(vx, vy, vz), c); // does not subtract infinity if known by a functional constraint
                 }
             } else {
-                costs[vx * sizeY * sizeZ + vy * sizeZ + vz] += c;
+                addTableCost(tupleIndex(vx, vy, vz), c);
             }
         }
     }
@@ -463,7 +509,7 @@ public:
         vindex[getIndex(yin)] = vy;
         vindex[getIndex(zin)] = vz;
 
-        if (costs.empty()) {
+        if (functionalX) {
             if (x->toValue(vindex[0]) == functionX[vindex[1] * sizeZ + vindex[2]])
                 costsYZ[vindex[1] * sizeZ + vindex[2]] += c;
         } else {
@@ -472,10 +518,10 @@ public:
                 Value valyi = y->toValue(vindex[1]);
                 Value valzi = z->toValue(vindex[2]);
                 if ((!functionalX || getFunctionX(valyi, valzi) == valxi) && (!functionalY || getFunctionY(valxi, valzi) == valyi) && (!functionalZ || getFunctionZ(valxi, valyi) == valzi)) {
-                    costs[vindex[0] * sizeY * sizeZ + vindex[1] * sizeZ + vindex[2]] += c; // does not subtract infinity if known by a functional constraint
+                    addTableCost(tupleIndex(vindex[0], vindex[1], vindex[2]), c); // does not subtract infinity if known by a functional constraint
                 }
             } else {
-                costs[vindex[0] * sizeY * sizeZ + vindex[1] * sizeZ + vindex[2]] += c;
+                addTableCost(tupleIndex(vindex[0], vindex[1], vindex[2]), c);
             }
         }
     }
@@ -485,7 +531,7 @@ public:
         unsigned int vx = x->toIndex(vxi);
         unsigned int vy = y->toIndex(vyi);
         unsigned int vz = z->toIndex(vzi);
-        if (costs.empty()) {
+        if (functionalX) {
             if (vxi == functionX[vy * sizeZ + vz])
                 costsYZ[vy * sizeZ + vz] = c;
             else if (!CUT(wcsp->getLb() + c, wcsp->getUb())) {
@@ -493,7 +539,7 @@ public:
                 exit(EXIT_FAILURE);
             }
         } else
-            costs[vx * sizeY * sizeZ + vy * sizeZ + vz] = c;
+            setTableCost(tupleIndex(vx, vy, vz), c);
     }
 
     void setcost(EnumeratedVariable* xin, EnumeratedVariable* yin, EnumeratedVariable* zin, Value vxi, Value vyi, Value vzi, Cost c)
@@ -505,7 +551,7 @@ public:
         vindex[getIndex(xin)] = vx;
         vindex[getIndex(yin)] = vy;
         vindex[getIndex(zin)] = vz;
-        if (costs.empty()) {
+        if (functionalX) {
             if (x->toValue(vindex[0]) == functionX[vindex[1] * sizeZ + vindex[2]])
                 costsYZ[vindex[1] * sizeZ + vindex[2]] = c;
             else if (!CUT(c, wcsp->getUb())) {
@@ -513,7 +559,7 @@ public:
                 exit(EXIT_FAILURE);
             }
         } else
-            costs[vindex[0] * sizeY * sizeZ + vindex[1] * sizeZ + vindex[2]] = c;
+            setTableCost(tupleIndex(vindex[0], vindex[1], vindex[2]), c);
     }
 
     void setInfiniteCost(Cost ub)
@@ -525,7 +571,7 @@ public:
                 unsigned int iy = y->toIndex(*itery);
                 for (EnumeratedVariable::iterator iterz = z->begin(); iterz != z->end(); ++iterz) {
                     unsigned int iz = z->toIndex(*iterz);
-                    if (costs.empty()) {
+                    if (functionalX) {
                         if (*iterx == functionX[iy * sizeZ + iz]) {
                             Cost cost = costsYZ[iy * sizeZ + iz];
                             Cost delta = deltaCostsX[ix] + deltaCostsY[iy] + deltaCostsZ[iz];
@@ -533,10 +579,10 @@ public:
                                 costsYZ[iy * sizeZ + iz] = mult_ub + delta;
                         }
                     } else {
-                        Cost cost = costs[ix * sizeY * sizeZ + iy * sizeZ + iz];
+                        Cost cost = tableCost(tupleIndex(ix, iy, iz));
                         Cost delta = deltaCostsX[ix] + deltaCostsY[iy] + deltaCostsZ[iz];
                         if (CUT(cost - delta, ub))
-                            costs[ix * sizeY * sizeZ + iy * sizeZ + iz] = mult_ub + delta;
+                            setTableCost(tupleIndex(ix, iy, iz), mult_ub + delta);
                     }
                 }
             }
@@ -617,6 +663,22 @@ public:
             break;
         }
     }
+    /// \note each variable is revised once even if both other variables have lost values
+    void removes(uint64_t indexes)
+    {
+        bool revise[3];
+        for (int i = 0; i < 3; i++) {
+            revise[i] = (indexes & ~((uint64_t)1 << i)) != 0;
+            if (revise[i])
+                getVar(i)->queueDEE();
+        }
+        if (revise[0] && connected() && (ToulBar2::LcLevel == LC_AC || getDACScopeIndex() != 0))
+            findSupportX();
+        if (revise[1] && connected() && (ToulBar2::LcLevel == LC_AC || getDACScopeIndex() != 1))
+            findSupportY();
+        if (revise[2] && connected() && (ToulBar2::LcLevel == LC_AC || getDACScopeIndex() != 2))
+            findSupportZ();
+    }
 
     void projectFromZero(int varIndex)
     {
@@ -804,6 +866,7 @@ public:
     { // extend binary cost functions to the ternary cost function
         Cost c;
         bool isbincost = false;
+        bool wassparse = sparse;
         for (EnumeratedVariable::iterator iterx = x->begin(); iterx != x->end(); ++iterx) {
             for (EnumeratedVariable::iterator itery = y->begin(); itery != y->end(); ++itery) {
                 for (EnumeratedVariable::iterator iterz = z->begin(); iterz != z->end(); ++iterz) {
@@ -829,6 +892,9 @@ public:
             }
         }
 
+        if (wassparse && !sparse)
+            selectStorage(); // the table has been made dense by the extension
+
         xy->clearCosts();
         xz->clearCosts();
         yz->clearCosts();
@@ -1050,19 +1116,18 @@ public:
         sizeY = y->getDomainInitSize();
         sizeZ = z->getDomainInitSize();
         if (sizeX > deltaCostsX.size())
-            deltaCostsX.resize(sizeX, StoreCost(MIN_COST));
+            deltaCostsX.resize(sizeX, MIN_COST);
         if (sizeY > deltaCostsY.size())
-            deltaCostsY.resize(sizeY, StoreCost(MIN_COST));
+            deltaCostsY.resize(sizeY, MIN_COST);
         if (sizeZ > deltaCostsZ.size())
-            deltaCostsZ.resize(sizeZ, StoreCost(MIN_COST));
+            deltaCostsZ.resize(sizeZ, MIN_COST);
         if (sizeX > supportX.size())
             supportX.resize(sizeX);
         if (sizeY > supportY.size())
             supportY.resize(sizeY);
         if (sizeZ > supportZ.size())
             supportZ.resize(sizeZ);
-        if (sizeX * sizeY * sizeZ > costs.size())
-            costs.resize(sizeX * sizeY * sizeZ, StoreCost(MIN_COST));
+        costs.enlarge(sizeX * sizeY * sizeZ, MIN_COST);
         linkX->removed = true;
         linkY->removed = true;
         linkZ->removed = true;
@@ -1086,7 +1151,7 @@ public:
     void print(ostream& os);
     void dump(ostream& os, bool original = true);
     Long size() const FINAL { return (Long)sizeX * sizeY * sizeZ; }
-    Long space() const FINAL { return (Long)sizeof(StoreCost) * sizeX * sizeY * sizeZ; }
+    Long space() const FINAL { return (Long)sizeof(Cost) * sizeX * sizeY * sizeZ; }
 
     friend struct Functor_getCostXYZ;
     friend struct Functor_getCostXZY;
@@ -1335,7 +1400,7 @@ template <typename T1, typename T2, typename T3>
 void TernaryConstraint::findSupport(T1 getCost, bool functionalY, T2 getFunctionY, bool functionalZ, T3 getFunctionZ,
     EnumeratedVariable* x, EnumeratedVariable* y, EnumeratedVariable* z,
     int getIndexX, int getIndexY, int getIndexZ,
-    vector<pair<Value, Value>>& supportX, vector<StoreCost>& deltaCostsX,
+    vector<pair<Value, Value>>& supportX, StoreCostArray& deltaCostsX,
     vector<pair<Value, Value>>& supportY, vector<pair<Value, Value>>& supportZ)
 {
     assert(getIndex(y) < getIndex(z)); // check that support.first/.second is consistent with y/z parameters
@@ -1350,6 +1415,9 @@ void TernaryConstraint::findSupport(T1 getCost, bool functionalY, T2 getFunction
              << *z << endl
              << *this;
     bool supportBroken = false;
+    bool sparseSupport = (sparse && !functionalY && !functionalZ);
+    if (sparseSupport)
+        prepareSparseOrder(getIndexX);
     for (EnumeratedVariable::iterator iterX = x->begin(); iterX != x->end(); ++iterX) {
         unsigned int xindex = x->toIndex(*iterX);
         pair<Value, Value> support = supportX[xindex];
@@ -1376,6 +1444,10 @@ void TernaryConstraint::findSupport(T1 getCost, bool functionalY, T2 getFunction
                         }
                     }
                 }
+            } else if (sparseSupport && sparse) {
+                unsigned int yindex, zindex;
+                minCost = sparseMinCost(getIndexX, xindex, yindex, zindex);
+                support = make_pair(y->toValue(yindex), z->toValue(zindex));
             } else {
                 for (EnumeratedVariable::iterator iterY = y->begin(); minCost > MIN_COST && iterY != y->end(); ++iterY) {
                     for (EnumeratedVariable::iterator iterZ = z->begin(); minCost > MIN_COST && iterZ != z->end(); ++iterZ) {
@@ -1420,9 +1492,9 @@ template <typename T1, typename T2, typename T3, typename T4, typename T5, typen
 void TernaryConstraint::findFullSupport(T1 getCost, T2 getCostXZY, T3 getCostYZX, T4 getCostWithBinaries, T5 addCost, T6 addCostXZY, T7 addCostYZX, bool functionalX, T8 getFunctionX, bool functionalY, T9 getFunctionY, bool functionalZ, T10 getFunctionZ,
     EnumeratedVariable* x, EnumeratedVariable* y, EnumeratedVariable* z,
     int getIndexX, int getIndexY, int getIndexZ,
-    vector<pair<Value, Value>>& supportX, vector<StoreCost>& deltaCostsX,
-    vector<pair<Value, Value>>& supportY, vector<StoreCost>& deltaCostsY,
-    vector<pair<Value, Value>>& supportZ, vector<StoreCost>& deltaCostsZ,
+    vector<pair<Value, Value>>& supportX, StoreCostArray& deltaCostsX,
+    vector<pair<Value, Value>>& supportY, StoreCostArray& deltaCostsY,
+    vector<pair<Value, Value>>& supportZ, StoreCostArray& deltaCostsZ,
     BinaryConstraint* xy, BinaryConstraint* xz, BinaryConstraint* yz)
 {
     assert(connected());
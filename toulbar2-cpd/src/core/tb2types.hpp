@@ -238,6 +238,15 @@ inline TLogProb GLogSubExp(TLogProb logc1, TLogProb logc2) // log[exp(c1) - exp(
 }
 
 const int STORE_SIZE = 16;
+const int STORE_RESERVE = (sizeof(void*) >= 8) ? 28 : 20; ///< log2 of the number of entries of virtual memory reserved for each trailing stack (see ::StoreStack)
+
+/// \brief encodings of a cost table (see ::StoreCostTable): unsigned offsets from a base cost on 16 or 32 bits, or plain costs
+enum CostWidth {
+    COSTWIDTH_16 = 0,
+    COSTWIDTH_32 = 1,
+    COSTWIDTH_PLAIN = 2
+};
+const int NB_COSTWIDTHS = 3;
 #define INTEGERBITS (8 * sizeof(Cost) - 2)
 
 const int MAX_ELIM_BIN = 1000000000;
@@ -444,7 +453,9 @@ namespace ToulBar2 {
     extern int preprocessFunctional;
     extern bool costfuncSeparate;
     extern int preprocessNary;
+    extern int preprocessThreads; // number of threads for independent computations on each cost function in preprocessing
     extern bool QueueComplexity;
+    extern bool propagationWaves; // revises each cost function once per wave of variables taken from the AC queue
     extern bool Static_variable_ordering; // flag for static variable ordering during search (dynamic ordering is default value)
     extern bool lastConflict;
     extern int weightedDegree;
@@ -452,10 +463,17 @@ namespace ToulBar2 {
     extern bool MSTDAC;
     extern int DEE;
     extern int DEE_;
+    extern bool DEEMatrix; // soft neighborhood substitutability on all pairs of values from matrices of bounded sums computed at once for variables with only binary cost functions
+    extern bool interchangeableValues; // merges the values having the same unary and binary costs at load time, solutions with the removed values are restored when counting and printing
     extern int nbDecisionVars;
     extern int lds;
+    extern int ldsJobs; // number of processes exploring distinct discrepancy levels concurrently
     extern bool limited;
     extern Long restart;
+    extern int maxNogoods; // maximum number of nogoods recorded from restarts (0 if no recording)
+    extern int dynamicComponents; // number of search nodes between two detections of independent subproblems (0 if no detection)
+    extern double sparseBinaryDensity; // maximum proportion of tuples not having the most frequent cost in binary cost functions stored sparsely (0 if dense storage only)
+    extern double sparseTernaryDensity; // same as sparseBinaryDensity for ternary cost functions
     extern externalevent setvalue;
     extern externalevent setmin;
     extern externalevent setmax;
@@ -500,7 +518,9 @@ namespace ToulBar2 {
     extern string deltaUbS;
     extern Cost deltaUb;
     extern bool singletonConsistency;
+    extern int sacJobs; // number of processes sharing the singleton consistency probes
     extern bool vacValueHeuristic;
+    extern bool vacWarmStart; // VAC threshold descent in search starting from the last threshold increasing the lower bound
     extern BEP* bep;
     extern LcLevelType LcLevel;
     extern bool wcnf;
@@ -593,6 +613,13 @@ namespace ToulBar2 {
     extern ptrdiff_t hbfsCPLimit; // limit on the number of choice points stored inside open node list
     extern ptrdiff_t hbfsOpenNodeLimit; // limit on the number of open nodes
 
+    extern string telemetryFile; // output file or Unix-domain socket (unix:path) for the JSON telemetry stream (empty if none)
+    extern double telemetryPeriod; // minimum wall-clock time in seconds between two telemetry records
+
+    extern string checkpointFile; // file where the hybrid best-first search state is periodically saved (empty if none)
+    extern double checkpointPeriod; // minimum wall-clock time in seconds between two checkpoints
+    extern bool resume; // if true, restarts hybrid best-first search from the last checkpoint (if any)
+
     extern bool verifyOpt; // if true, for debugging purposes, checks the given optimal solution (problem.sol) is not pruned during search
     extern Cost verifiedOptimum; // for debugging purposes, cost of the given optimal solution
 };
@@ -12,6 +12,7 @@
 
 #include "tb2vac.hpp"
 #include "search/tb2clusters.hpp"
+#include "utils/tb2parallelfor.hpp"
 
 class tVACStat {
 public:
@@ -37,6 +38,7 @@ VACExtension::VACExtension(WCSP* w)
     , VAC2(&Store::storeVariable)
     , nbIterations(0)
     , inconsistentVariable(-1)
+    , lastThreshold(MIN_COST)
 {
     queueP = new stack<pair<int, int>>;
     queueR = new stack<pair<int, int>>;
@@ -123,6 +125,9 @@ void VACExtension::iniThreshold()
     Cost c = ((it == scaleVAC.end()) ? UNIT_COST : (*it));
     if (wcsp->getUb() < c)
         c = wcsp->getUb();
+    // Bool(P) was found consistent for the thresholds above lastThreshold at the parent node, a decision rarely makes them effective again
+    if (ToulBar2::vacWarmStart && Store::getDepth() > 0 && lastThreshold > MIN_COST)
+        c = min(c, max((Cost)lastThreshold, ToulBar2::costThreshold));
     itThreshold = c;
     nearIncVar = NULL;
 }
@@ -263,6 +268,8 @@ bool VACExtension::propagate()
             if (ToulBar2::verbose > 0)
                 cout << "VAC dual bound: " << std::fixed << std::setprecision(ToulBar2::decimalPoint) << wcsp->getDDualBound() << std::setprecision(DECIMAL_POINT) << "    incvar: " << inconsistentVariable << "    minlambda: " << minlambda << "      itThreshold: " << itThreshold << endl;
             util = enforcePass3();
+            if (util)
+                lastThreshold = itThreshold;
         } else {
             nextScaleCost();
             //if(nearIncVar) cout << "var: " << nearIncVar->wcspIndex << "  at Cost: " << atThreshold << endl;
@@ -299,7 +306,6 @@ int VACExtension::getHeuristic()
 
 bool VACExtension::enforcePass1(VACVariable* xj, VACBinaryConstraint* cij)
 {
-    bool wipeout = false;
     VACVariable* xi;
     xi = (VACVariable*)cij->getVarDiffFrom(xj);
     for (EnumeratedVariable::iterator it = xi->begin(); it != xi->end();
@@ -309,17 +315,8 @@ bool VACExtension::enforcePass1(VACVariable* xj, VACBinaryConstraint* cij)
             xi->removeVAC(v);
         } // xi->queueVAC(); }
         else if (cij->revise(xi, v)) {
-            wipeout = xi->removeVAC(v);
-            xi->setKiller(v, xj->wcspIndex);
-            xj->killedOne(); // HEUR
-            queueP->push(pair<int, int>(xi->wcspIndex, v));
-            xi->queueVAC();
-            if (ToulBar2::vacValueHeuristic)
-                xi->queueSeekSupport();
-            if (wipeout) {
-                inconsistentVariable = xi->wcspIndex;
+            if (killPass1(xi, v, xj))
                 return true;
-            }
         }
     }
     //  if((xi->getDomainSize() == 1) && (!nearIncVar)) {
@@ -334,6 +331,77 @@ bool VACExtension::enforcePass1(VACVariable* xj, VACBinaryConstraint* cij)
     return false;
 }
 
+bool VACExtension::killPass1(VACVariable* xi, Value v, VACVariable* xj)
+{
+    bool wipeout = xi->removeVAC(v);
+    xi->setKiller(v, xj->wcspIndex);
+    xj->killedOne(); // HEUR
+    queueP->push(pair<int, int>(xi->wcspIndex, v));
+    xi->queueVAC();
+    if (ToulBar2::vacValueHeuristic)
+        xi->queueSeekSupport();
+    if (wipeout) {
+        inconsistentVariable = xi->wcspIndex;
+        return true;
+    }
+    return false;
+}
+
+/// \note only reads the problem, such that it can be called concurrently on the cost functions of \a xj (their other variables are distinct, as binary cost functions on the same pair are merged)
+void VACExtension::findPass1Events(VACVariable* xj, VACBinaryConstraint* cij, vector<Pass1Event>& events)
+{
+    VACVariable* xi = (VACVariable*)cij->getVarDiffFrom(xj);
+    vector<pair<Value, bool>> removed;
+    events.clear();
+    for (EnumeratedVariable::iterator it = xi->begin(); it != xi->end(); ++it) {
+        Value v = *it;
+        if (xi->getVACCost(v) != MIN_COST) {
+            events.push_back({ Pass1Event::REMOVE_UNARY, v, v });
+        } else {
+            Value support;
+            removed.clear();
+            bool killed = cij->findVACSupport(xi, v, support, &removed);
+            for (unsigned int k = 0; k < removed.size(); k++)
+                events.push_back({ (removed[k].second) ? Pass1Event::REMOVE_SUPPORT_QUEUE : Pass1Event::REMOVE_SUPPORT, removed[k].first, support });
+            events.push_back({ Pass1Event::SUPPORT, v, support });
+            if (killed)
+                events.push_back({ Pass1Event::KILL, v, support });
+        }
+    }
+}
+
+/// \note values of xj already removed before (by this cost function or a previous one of xj) are skipped, as they are not seen by revise in the sequential order
+bool VACExtension::applyPass1Events(VACVariable* xj, VACBinaryConstraint* cij, const vector<Pass1Event>& events)
+{
+    VACVariable* xi = (VACVariable*)cij->getVarDiffFrom(xj);
+    for (unsigned int e = 0; e < events.size(); e++) {
+        switch (events[e].kind) {
+        case Pass1Event::REMOVE_UNARY:
+            xi->removeVAC(events[e].value);
+            break;
+        case Pass1Event::REMOVE_SUPPORT:
+            if (xj->canbe(events[e].value))
+                xj->removeVAC(events[e].value);
+            break;
+        case Pass1Event::REMOVE_SUPPORT_QUEUE:
+            if (xj->canbe(events[e].value)) {
+                xj->removeVAC(events[e].value);
+                xj->queueVAC();
+            }
+            break;
+        case Pass1Event::SUPPORT:
+            wcsp->revise(cij);
+            cij->setSupport(xi, events[e].value, events[e].support);
+            break;
+        case Pass1Event::KILL:
+            if (killPass1(xi, events[e].value, xj))
+                return true;
+            break;
+        }
+    }
+    return false;
+}
+
 void VACExtension::enforcePass1()
 {
     //  VACVariable* xi;
@@ -341,8 +409,30 @@ void VACExtension::enforcePass1()
     VACBinaryConstraint* cij;
     //if (ToulBar2::verbose > 1) cout << "VAC Enforce Pass 1" << endl;
 
+    // in preprocessing, the cost functions of each variable are revised in parallel, their changes being applied in the sequential order
+    int nbThreads = (Store::getDepth() <= 1) ? ToulBar2::preprocessThreads : 1;
+    vector<VACBinaryConstraint*> cijs;
+    vector<vector<Pass1Event>> events;
+
     while (!VAC.empty()) {
         xj = (VACVariable*)VAC.pop_first();
+        if (nbThreads > 1) {
+            cijs.clear();
+            for (ConstraintList::iterator itc = xj->getConstrs()->begin(); itc != xj->getConstrs()->end(); ++itc) {
+                Constraint* c = (*itc).constr;
+                if (c->arity() == 2 && !c->isSep())
+                    cijs.push_back((VACBinaryConstraint*)c);
+            }
+            if (cijs.size() > 1) {
+                if (events.size() < cijs.size())
+                    events.resize(cijs.size());
+                parallelFor(cijs.size(), nbThreads, [this, xj, &cijs, &events](size_t i) { findPass1Events(xj, cijs[i], events[i]); });
+                for (unsigned int i = 0; i < cijs.size(); i++)
+                    if (applyPass1Events(xj, cijs[i], events[i]))
+                        return;
+                continue;
+            }
+        }
         //list<Constraint*> l;
         for (ConstraintList::iterator itc = xj->getConstrs()->begin();
              itc != xj->getConstrs()->end(); ++itc) {
@@ -762,6 +852,27 @@ void VACExtension::printTightMatrix()
 /* Min-Sum diffusion algorithm */
 void VACExtension::minsumDiffusion()
 {
+    // variables are averaged by classes of a greedy coloring of the constraint graph: the variables of a class share no cost function,
+    // such that a class can be averaged in parallel in preprocessing, the queues being updated afterwards in the order of the class
+    int nbThreads = (Store::getDepth() == 0) ? ToulBar2::preprocessThreads : 1;
+    vector<vector<VACVariable*>> classes;
+    vector<int> color(wcsp->numberOfVariables(), -1);
+    for (unsigned int i = 0; i < wcsp->numberOfVariables(); i++)
+        if (wcsp->unassigned(i)) {
+            VACVariable* evar = (VACVariable*)wcsp->getVar(i);
+            vector<bool> used(classes.size() + 1, false);
+            for (ConstraintList::iterator iter = evar->getConstrs()->begin(); iter != evar->getConstrs()->end(); ++iter) {
+                Constraint* ctr = (*iter).constr;
+                for (int k = 0; k < ctr->arity(); k++)
+                    if (color[ctr->getVar(k)->wcspIndex] >= 0)
+                        used[color[ctr->getVar(k)->wcspIndex]] = true;
+            }
+            color[i] = find(used.begin(), used.end(), false) - used.begin();
+            if (color[i] == (int)classes.size())
+                classes.push_back(vector<VACVariable*>());
+            classes[color[i]].push_back(evar);
+        }
+
     for (int times = 0; times < 2; times++) {
         bool change = true;
         int maxit = ToulBar2::minsumDiffusion;
@@ -774,16 +885,20 @@ void VACExtension::minsumDiffusion()
         while (change && (ntimes < maxit)) {
             change = false;
             int nchanged = 0;
-            for (unsigned int i = 0; i < wcsp->numberOfVariables();
-                 i++)
-                if (wcsp->unassigned(i)) {
-                    VACVariable* evar = (VACVariable*)wcsp->getVar(i);
-                    if (evar->averaging()) {
+            for (unsigned int c = 0; c < classes.size(); c++) {
+                vector<VACVariable*>& vars = classes[c];
+                vector<char> changed(vars.size(), false);
+                parallelFor(vars.size(), nbThreads, [&vars, &changed](size_t i) { changed[i] = vars[i]->unassigned() && vars[i]->averaging(); });
+                for (unsigned int i = 0; i < vars.size(); i++)
+                    if (changed[i]) {
                         change = true;
                         nchanged++;
-                        evar->findSupport();
+                        vars[i]->queueDAC();
+                        vars[i]->queueEAC1();
+                        vars[i]->propagateNC();
+                        vars[i]->findSupport();
                     }
-                }
+            }
             ntimes++;
             //cout << "it " << ntimes << "   changed: " << nchanged << endl;
         }
@@ -26,6 +26,7 @@ private:
     int inconsistentVariable; /**< WipeOut variable, Used also to check after enforcePass1() if the network is VAC */
 
     Cost itThreshold; /**< The cost threshold (theta) for the iterative threshold descent */
+    StoreCost lastThreshold; /**< Backtrackable; the last threshold which increased c0 at the current node or above (warm start of the threshold descent, see ToulBar2::vacWarmStart) */
     int breakCycles; /**< Number of iterations with no c0 increase */
     tScale scaleCost; /**w The list of all costs used in the WCSP ? */
     list<Cost> scaleVAC; /**< The scale of costs used for the thresold descent */
@@ -35,8 +36,24 @@ private:
     stack<pair<int, Value>>* queueP; /**< Values removed by hard AC (created in Pass1, used in Pass2) */
     stack<pair<int, Value>>* queueR; /**< Minimal set of deletions needed to increase c0 (created in Pass2, used in Pass3) */
 
+    /** A change of Bool(P) made by enforcePass1(xj, cij), found without modifying the problem (see findPass1Events) */
+    struct Pass1Event {
+        enum Kind {
+            REMOVE_UNARY, /**< value of xi removed because of its unary cost */
+            REMOVE_SUPPORT, /**< value of xj removed because of its unary cost while searching a support */
+            REMOVE_SUPPORT_QUEUE, /**< same as REMOVE_SUPPORT, xj being queued */
+            SUPPORT, /**< new support of a value of xi */
+            KILL /**< value of xi removed because it has no support */
+        } kind;
+        Value value;
+        Value support;
+    };
+
     void enforcePass1(); /**< Enforces instrumented hard AC (Phase 1) */
     bool enforcePass1(VACVariable* xj, VACBinaryConstraint* cij); /**< Revises /a xj wrt /a cij and updates /a k */
+    bool killPass1(VACVariable* xi, Value v, VACVariable* xj); /**< Removes a value of /a xi without support on /a xj, returns true if wipeout */
+    void findPass1Events(VACVariable* xj, VACBinaryConstraint* cij, vector<Pass1Event>& events); /**< Same as enforcePass1(xj, cij) without modifying the problem */
+    bool applyPass1Events(VACVariable* xj, VACBinaryConstraint* cij, const vector<Pass1Event>& events); /**< Applies the changes found by findPass1Events */
     bool checkPass1() const; /**< Checks if Bool(P) is AC */
     void enforcePass2(); /**< Finds a minimal set of deletions needed for wipeout and computes k and lambda */
     bool enforcePass3(); /**< Project and extends costs to increase c0 according to the plan */
@@ -76,7 +93,7 @@ public:
     void dequeueVAC2(DLink<Variable*>* link);
 
     void init();
-    void iniThreshold(); /**< Initialize itThreshold to the strongest cost in the cost scale */
+    void iniThreshold(); /**< Initialize itThreshold to the strongest cost in the cost scale, or to lastThreshold in search if ToulBar2::vacWarmStart */
     Cost getThreshold() { return itThreshold; }
     void nextScaleCost(); /**< Sets ItThreshold to the next scale */
     void histogram(Cost c);
@@ -304,10 +304,7 @@ bool VACVariable::averaging()
                     for (iterator itx = x->begin(); itx != x->end(); ++itx) {
                         bctr->addcost(this, x, *it, *itx, costi);
                     }
-                    if (mean > to_double(cu))
-                        project(*it, -costi);
-                    else
-                        extend(*it, costi);
+                    costs[toIndex(*it)] -= costi; // projects -costi if positive, else extends costi, queues being updated by the caller
                     change = true;
                 }
             }
@@ -337,10 +334,7 @@ bool VACVariable::averaging()
                             tctr->addCost(this, x, y, *it, *itx, *ity, costi);
                         }
                     }
-                    if (mean > to_double(cu))
-                        project(*it, -costi);
-                    else
-                        extend(*it, costi);
+                    costs[toIndex(*it)] -= costi; // projects -costi if positive, else extends costi, queues being updated by the caller
                     change = true;
                 }
             }
@@ -367,10 +361,7 @@ bool VACVariable::averaging()
                 if (abs(extc) >= 1) {
                     Cost costi = (Cost)extc;
                     nctr->addtoTuples(this, *it, costi);
-                    if (mean > to_double(cu))
-                        project(*it, -costi);
-                    else
-                        extend(*it, costi);
+                    costs[toIndex(*it)] -= costi; // projects -costi if positive, else extends costi, queues being updated by the caller
                     change = true;
                 }
             }
@@ -497,7 +488,18 @@ bool VACBinaryConstraint::isNull(Cost c)
 bool VACBinaryConstraint::revise(VACVariable* var, Value v)
 {
     wcsp->revise(this);
-    //  bool wipeout = false;
+    Value support;
+    bool wipeout = findVACSupport(var, v, support, NULL);
+    setSupport(var, v, support);
+    return wipeout;
+}
+
+/// \brief searches a support of (\a var, \a v) in Bool(P), starting from its current support, and removes the values of the other variable found with a nonzero unary cost
+/// \param support (out) the support found, or the value of minimum binary cost if there is none
+/// \param removed if not NULL, the values to remove are appended to it (with true if the other variable must be queued) instead of being removed, such that the problem is not modified
+/// \return true if (\a var, \a v) has no support in Bool(P)
+bool VACBinaryConstraint::findVACSupport(VACVariable* var, Value v, Value& support, vector<pair<Value, bool>>* removed)
+{
     VACVariable* xi = (VACVariable*)getVar(0);
     VACVariable* xj = (VACVariable*)getVar(1);
     Value sup = getSupport(var, v);
@@ -507,10 +509,22 @@ bool VACBinaryConstraint::revise(VACVariable* var, Value v)
         xj = (VACVariable*)getVar(0);
     }
     Cost cost, minCost = wcsp->getUb();
+    auto remove = [xj, removed](Value w, bool queue) {
+        if (removed) {
+            removed->push_back(make_pair(w, queue));
+        } else {
+            xj->removeVAC(w);
+            if (queue)
+                xj->queueVAC();
+        }
+    };
+    bool supRemoved = false;
+    support = sup;
 
     if (xj->canbe(sup)) {
         if (xj->getVACCost(sup) != MIN_COST) {
-            xj->removeVAC(sup);
+            remove(sup, false);
+            supRemoved = true;
         } // wipeout = xj->removeVAC(sup);
         else {
             if (getVACCost(xi, xj, v, sup) == MIN_COST) {
@@ -521,14 +535,15 @@ bool VACBinaryConstraint::revise(VACVariable* var, Value v)
 
     for (EnumeratedVariable::iterator it = xj->lower_bound(sup); it != xj->end(); ++it) {
         Value w = *it;
+        if (w == sup && supRemoved) // still in the domain if its removal is delayed
+            continue;
         if (xj->getVACCost(w) != MIN_COST) {
-            xj->removeVAC(w);
-            xj->queueVAC();
+            remove(w, true);
         } // wipeout = xj->removeVAC(w); xj->queueVAC();
         else {
             cost = getVACCost(xi, xj, v, w);
             if (cost == MIN_COST) {
-                setSupport(xi, v, w);
+                support = w;
                 return false;
             } else if (cost < minCost) {
                 minCost = cost;
@@ -539,13 +554,12 @@ bool VACBinaryConstraint::revise(VACVariable* var, Value v)
     for (EnumeratedVariable::iterator it = xj->begin(); it != xj->lower_bound(sup); ++it) {
         Value w = *it;
         if (xj->getVACCost(w) != MIN_COST) {
-            xj->removeVAC(w);
-            xj->queueVAC();
+            remove(w, true);
         } // wipeout = xj->removeVAC(w); xj->queueVAC();
         else {
             cost = getVACCost(xi, xj, v, w);
             if (cost == MIN_COST) {
-                setSupport(xi, v, w);
+                support = w;
                 return false;
             } else if (cost < minCost) {
                 minCost = cost;
@@ -554,7 +568,7 @@ bool VACBinaryConstraint::revise(VACVariable* var, Value v)
         }
     }
 
-    setSupport(xi, v, minsup);
+    support = minsup;
     return true;
 }
 
@@ -125,7 +125,7 @@ public:
     void VACproject(Value v, const Cost c); /**< Increases unary cost and may queue for NC enforcing */
     void VACextend(Value v, const Cost c); /**< Decreases unary cost and may queue for NC enforcing */
 
-    bool averaging(); /**< For Min-Sum diffusion */
+    bool averaging(); /**< For Min-Sum diffusion, only modifies the unary costs of this variable and its cost functions (without queueing) */
 
     friend ostream& operator<<(ostream& os, VACVariable& v)
     {
@@ -174,6 +174,7 @@ public:
     void VACextend(VACVariable* x, Value v, Cost c); /**< Modifies Delta counters, then VAC extends from value */
 
     bool revise(VACVariable* var, Value v); /**< AC2001 based Revise for Pass1 : Revise value wrt this cost function */
+    bool findVACSupport(VACVariable* var, Value v, Value& support, vector<pair<Value, bool>>* removed); /**< Support search of revise, possibly without modifying the problem */
 
     friend ostream& operator<<(ostream& os, VACBinaryConstraint& c)
     {
@@ -221,6 +222,7 @@ public:
     void VACextend(VACVariable* x, Value v, Cost c); /**< Modifies Delta counters, then VAC extends from value */
 
     bool revise(VACVariable* var, Value v); /**< AC2001 based Revise for Pass1 : Revise value wrt this cost function */
+    bool findVACSupport(VACVariable* var, Value v, Value& support, vector<pair<Value, bool>>* removed); /**< Support search of revise, possibly without modifying the problem */
 
     friend ostream& operator<<(ostream& os, VACTernaryConstraint& c)
     {
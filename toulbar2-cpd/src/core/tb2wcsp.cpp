@@ -41,6 +41,7 @@
 #include "globals/tb2maxconstr.hpp"
 #include "tb2clause.hpp"
 #include "tb2clqcover.hpp"
+#include "utils/tb2parallelfor.hpp"
 
 /*
  * Global variables with their default value
@@ -52,6 +53,10 @@ StoreStack<BTList<Value>, DLink<Value>*> Store::storeDomain(STORE_SIZE);
 StoreStack<BTList<ConstraintLink>, DLink<ConstraintLink>*> Store::storeConstraint(STORE_SIZE);
 StoreStack<BTList<Variable*>, DLink<Variable*>*> Store::storeVariable(STORE_SIZE);
 StoreStack<BTList<Separator*>, DLink<Separator*>*> Store::storeSeparator(STORE_SIZE);
+StoreStack<CostBlock, CostBlock> Store::storeCostBlock(STORE_SIZE);
+StoreStack<StoreCostArray, CostTableFormat> Store::storeCostArray(STORE_SIZE);
+StoreStack<StoreCostTable, CostTableFormat> Store::storeCostTable(STORE_SIZE);
+Long Store::stamp = 0;
 
 int WCSP::wcspCounter = 0;
 
@@ -73,8 +78,10 @@ int ToulBar2::preprocessTernaryRPC;
 int ToulBar2::preprocessFunctional;
 bool ToulBar2::costfuncSeparate;
 int ToulBar2::preprocessNary;
+int ToulBar2::preprocessThreads;
 LcLevelType ToulBar2::LcLevel;
 bool ToulBar2::QueueComplexity;
+bool ToulBar2::propagationWaves;
 bool ToulBar2::binaryBranching;
 bool ToulBar2::lastConflict;
 int ToulBar2::dichotomicBranching;
@@ -83,8 +90,13 @@ bool ToulBar2::sortDomains;
 map<int, ValueCost*> ToulBar2::sortedDomains;
 bool ToulBar2::solutionBasedPhaseSaving;
 int ToulBar2::lds;
+int ToulBar2::ldsJobs;
 bool ToulBar2::limited;
 Long ToulBar2::restart;
+int ToulBar2::maxNogoods;
+int ToulBar2::dynamicComponents;
+double ToulBar2::sparseBinaryDensity;
+double ToulBar2::sparseTernaryDensity;
 bool ToulBar2::generation;
 int ToulBar2::minsumDiffusion;
 int ToulBar2::prodsumDiffusion;
@@ -94,9 +106,13 @@ int ToulBar2::weightedTightness;
 bool ToulBar2::MSTDAC;
 int ToulBar2::DEE;
 int ToulBar2::DEE_;
+bool ToulBar2::DEEMatrix;
+bool ToulBar2::interchangeableValues;
 int ToulBar2::nbDecisionVars;
 bool ToulBar2::singletonConsistency;
+int ToulBar2::sacJobs;
 bool ToulBar2::vacValueHeuristic;
+bool ToulBar2::vacWarmStart;
 
 externalevent ToulBar2::setvalue;
 externalevent ToulBar2::setmin;
@@ -238,6 +254,13 @@ Long ToulBar2::hbfsBeta; // inverse of maximum node redundancy goal limit
 ptrdiff_t ToulBar2::hbfsCPLimit; // limit on the number of choice points stored inside open node list
 ptrdiff_t ToulBar2::hbfsOpenNodeLimit; // limit on the number of open nodes
 
+string ToulBar2::telemetryFile;
+double ToulBar2::telemetryPeriod;
+
+string ToulBar2::checkpointFile;
+double ToulBar2::checkpointPeriod;
+bool ToulBar2::resume;
+
 bool ToulBar2::verifyOpt;
 Cost ToulBar2::verifiedOptimum;
 
@@ -265,8 +288,10 @@ void tb2init()
     ToulBar2::preprocessFunctional = 1;
     ToulBar2::costfuncSeparate = true;
     ToulBar2::preprocessNary = 10;
+    ToulBar2::preprocessThreads = 1;
     ToulBar2::LcLevel = LC_EDAC;
     ToulBar2::QueueComplexity = false;
+    ToulBar2::propagationWaves = false;
     ToulBar2::binaryBranching = true;
     ToulBar2::lastConflict = true;
     ToulBar2::dichotomicBranching = 1;
@@ -274,8 +299,13 @@ void tb2init()
     ToulBar2::sortDomains = false;
     ToulBar2::solutionBasedPhaseSaving = true;
     ToulBar2::lds = 0;
+    ToulBar2::ldsJobs = 1;
     ToulBar2::limited = false;
     ToulBar2::restart = -1;
+    ToulBar2::maxNogoods = 0;
+    ToulBar2::dynamicComponents = 0;
+    ToulBar2::sparseBinaryDensity = 0.1;
+    ToulBar2::sparseTernaryDensity = 0.1;
     ToulBar2::generation = false;
     ToulBar2::minsumDiffusion = 0;
     ToulBar2::prodsumDiffusion = 0;
@@ -285,9 +315,13 @@ void tb2init()
     ToulBar2::MSTDAC = false;
     ToulBar2::DEE = 1;
     ToulBar2::DEE_ = 0;
+    ToulBar2::DEEMatrix = false;
+    ToulBar2::interchangeableValues = false;
     ToulBar2::nbDecisionVars = 0;
     ToulBar2::singletonConsistency = false;
+    ToulBar2::sacJobs = 1;
     ToulBar2::vacValueHeuristic = true;
+    ToulBar2::vacWarmStart = false;
 
     ToulBar2::setvalue = NULL;
     ToulBar2::setmin = NULL;
@@ -411,6 +445,13 @@ void tb2init()
     ToulBar2::hbfsCPLimit = CHOICE_POINT_LIMIT;
     ToulBar2::hbfsOpenNodeLimit = OPEN_NODE_LIMIT;
 
+    ToulBar2::telemetryFile = "";
+    ToulBar2::telemetryPeriod = 1.;
+
+    ToulBar2::checkpointFile = "";
+    ToulBar2::checkpointPeriod = 600.;
+    ToulBar2::resume = false;
+
     ToulBar2::verifyOpt = false;
     ToulBar2::verifiedOptimum = MAX_COST;
 }
@@ -472,6 +513,10 @@ void tb2checkOptions()
     if (ToulBar2::allSolutions || ToulBar2::isZ) {
         ToulBar2::DEE = 0;
     }
+    if (ToulBar2::interchangeableValues && (ToulBar2::isZ || (ToulBar2::allSolutions && ToulBar2::btdMode >= 1))) {
+        cout << "Warning! Cannot merge interchangeable values when computing the partition function or counting solutions with tree decomposition." << endl;
+        ToulBar2::interchangeableValues = false;
+    }
     //TODO: could use negative ub but will be translated.
     if (ToulBar2::isZ && ToulBar2::isZUB < 0) {
         cout << "Warning! Upperbound level minimum is 0, for exact computing set epsilon or sigma to 0" << endl;
@@ -487,6 +532,14 @@ void tb2checkOptions()
         cout << "Warning! Hybrid best-first search not compatible with Limited Discrepancy Search." << endl;
         ToulBar2::hbfs = 0;
     }
+    if (ToulBar2::ldsJobs > 1 && (ToulBar2::allSolutions || ToulBar2::isZ)) {
+        cout << "Warning! Parallel Limited Discrepancy Search not compatible with solution counting." << endl;
+        ToulBar2::ldsJobs = 1;
+    }
+    if (ToulBar2::sacJobs > 1 && ToulBar2::vac) {
+        cout << "Warning! Parallel singleton consistency not compatible with VAC." << endl;
+        ToulBar2::sacJobs = 1;
+    }
     if (ToulBar2::lds && ToulBar2::solutionBasedPhaseSaving) {
         // cout << "Warning! Solution based phase saving is not recommended with Limited Discrepancy Search." << endl;
         ToulBar2::solutionBasedPhaseSaving = false;
@@ -565,6 +618,36 @@ void tb2checkOptions()
         cerr << "Error: Z* algorithm cannot rely on HBFS for weighted counting." << endl;
         exit(EXIT_FAILURE);
     }
+    if (ToulBar2::maxNogoods > 0 && (ToulBar2::restart < 1 || ToulBar2::searchMethod != DFBB || ToulBar2::lds || ToulBar2::allSolutions || ToulBar2::isZ)) {
+        cout << "Warning! Nogood recording requires depth-first search with restart (use -L option) for optimization only." << endl;
+        ToulBar2::maxNogoods = 0;
+    }
+    if (ToulBar2::maxNogoods > 0 && ToulBar2::hbfs) {
+        cout << "Warning! Hybrid best-first search not compatible with nogood recording from restarts." << endl;
+        ToulBar2::hbfs = 0;
+        ToulBar2::hbfsGlobalLimit = 0;
+    }
+    if (ToulBar2::maxNogoods > 0 && ToulBar2::elimDegree >= 0) {
+        cout << "Warning! Cannot perform variable elimination during search with nogood recording." << endl;
+        ToulBar2::elimDegree = -1;
+    }
+    if (ToulBar2::dynamicComponents > 0 && (ToulBar2::btdMode >= 1 || ToulBar2::searchMethod != DFBB || ToulBar2::lds || ToulBar2::allSolutions || ToulBar2::isZ || ToulBar2::maxNogoods > 0 || ToulBar2::vac > 1 || ToulBar2::bep || ToulBar2::scpbranch)) {
+        cout << "Warning! Dynamic decomposition into independent subproblems is restricted to depth-first or hybrid best-first search for optimization, without tree decomposition, nogood recording nor VAC during search." << endl;
+        ToulBar2::dynamicComponents = 0;
+    }
+    if (ToulBar2::dynamicComponents > 0 && ToulBar2::elimDegree >= 0) {
+        cout << "Warning! Cannot perform variable elimination during search with dynamic decomposition into independent subproblems." << endl;
+        ToulBar2::elimDegree = -1;
+    }
+    if (ToulBar2::resume && ToulBar2::checkpointFile.empty()) {
+        cerr << "Error: no checkpoint file given to resume from (use --checkpoint option)." << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (!ToulBar2::checkpointFile.empty() && (!ToulBar2::hbfs || ToulBar2::btdMode >= 1 || ToulBar2::isZ || ToulBar2::allSolutions || ToulBar2::sortDomains)) {
+        cout << "Warning! Checkpoints are only available for hybrid best-first search without tree decomposition, solution counting nor sorted domains." << endl;
+        ToulBar2::checkpointFile = "";
+        ToulBar2::resume = false;
+    }
 }
 
 /*
@@ -585,6 +668,9 @@ WCSP::WCSP(Cost upperBound, void* _solver_)
     , objectiveChanged(false)
     , nbNodes(0)
     , nbDEE(0)
+    , waveStamp(0)
+    , nbWaveRemoves(0)
+    , nbWaveRevisions(0)
     , lastConflictConstr(NULL)
     , maxdomainsize(0)
     ,
@@ -835,7 +921,10 @@ int WCSP::postTernaryConstraint(int xIndex, int yIndex, int zIndex, vector<Cost>
             }
         }
 
-        ctr = new TernaryConstraint(this, x, y, z, xy, xz, yz, costs);
+        // tables mostly at the same cost are stored sparsely (unless they are functional)
+        Cost defaultCost = MIN_COST;
+        bool sparse = TernaryConstraint::sparseStorage(costs, defaultCost);
+        ctr = new TernaryConstraint(this, x, y, z, xy, xz, yz, costs, sparse, defaultCost);
     } else {
         ctr->addCosts(x, y, z, costs);
         ctr->propagate();
@@ -1881,6 +1970,40 @@ void WCSP::processTernary()
     }
 }
 
+/// \note variables are scanned in parallel (see EnumeratedVariable::findInterchangeableValues), then the values are removed at the current depth
+/// \note with a restricted set of decision variables, only their values are merged in order to count their assignments
+void WCSP::mergeInterchangeableValues()
+{
+    vector<vector<pair<Value, Value>>> merged(vars.size());
+    parallelFor(vars.size(), ToulBar2::preprocessThreads, [this, &merged](size_t i) {
+        if (vars[i]->enumerated() && vars[i]->unassigned() && (ToulBar2::nbDecisionVars <= 0 || (int)i < ToulBar2::nbDecisionVars)) {
+            const vector<char>* aa = (ToulBar2::cpd && i < ToulBar2::cpd->getRotamers2AA().size()) ? &ToulBar2::cpd->getRotamers2AA()[i] : NULL;
+            ((EnumeratedVariable*)vars[i])->findInterchangeableValues(aa, merged[i]);
+        }
+    });
+    interchangeableValues.resize(vars.size());
+    unsigned int nbmerged = 0;
+    for (unsigned int i = 0; i < vars.size(); i++) {
+        for (unsigned int j = 0; j < merged[i].size(); j++) {
+            interchangeableValues[i][merged[i][j].second].push_back(merged[i][j].first);
+            vars[i]->remove(merged[i][j].first);
+            nbmerged++;
+        }
+    }
+    if (ToulBar2::verbose >= 0 && nbmerged > 0)
+        cout << "Merged " << nbmerged << " interchangeable values." << endl;
+    propagate();
+}
+
+const vector<Value>& WCSP::getInterchangeableValues(int varIndex, Value value) const
+{
+    static const vector<Value> none;
+    if ((size_t)varIndex >= interchangeableValues.size())
+        return none;
+    map<Value, vector<Value>>::const_iterator iter = interchangeableValues[varIndex].find(value);
+    return (iter != interchangeableValues[varIndex].end()) ? iter->second : none;
+}
+
 /// \defgroup preprocessing Preprocessing techniques
 /// Depending on toulbar2 options, the sequence of preprocessing techniques applied before the search is:
 /// -# \e i-bounded variable elimination with user-defined \e i bound
@@ -2133,6 +2256,13 @@ void WCSP::preprocessing()
         propagate();
     } while (numberOfUnassignedVariables() < nbunvar);
 
+    // ternary tables can have become mostly equal to a single cost (or no more) after projections
+    vector<TernaryConstraint*> ternaries;
+    for (unsigned int i = 0; i < constrs.size(); i++)
+        if (constrs[i]->connected() && !constrs[i]->isSep() && constrs[i]->isTernary())
+            ternaries.push_back((TernaryConstraint*)constrs[i]);
+    parallelFor(ternaries.size(), ToulBar2::preprocessThreads, [&ternaries](size_t i) { ternaries[i]->selectStorage(); });
+
     if (ToulBar2::elimDegree >= 0 || ToulBar2::elimDegree_preprocessing >= 0 || ToulBar2::preprocessFunctional > 0) {
         ToulBar2::elimDegree_preprocessing_ = -1;
         if (ToulBar2::elimDegree >= 0) {
@@ -2708,6 +2838,10 @@ void WCSP::propagateAC()
 {
     if (ToulBar2::verbose >= 2)
         cout << "ACQueue size: " << AC.getSize() << endl;
+    if (ToulBar2::propagationWaves) {
+        propagateACWaves();
+        return;
+    }
     while (!AC.empty()) {
         EnumeratedVariable* x = (EnumeratedVariable*)((ToulBar2::QueueComplexity) ? AC.pop_min() : AC.pop());
         if (x->unassigned())
@@ -2717,6 +2851,51 @@ void WCSP::propagateAC()
     }
 }
 
+/// \brief same as propagateAC, taking all the variables of the queue at once (a wave) and revising each cost function once per wave
+/// \note variables are swept in DAC order and the cost functions in their first order of appearance
+void WCSP::propagateACWaves()
+{
+    while (!AC.empty()) {
+        waveVars.clear();
+        while (!AC.empty()) {
+            EnumeratedVariable* x = (EnumeratedVariable*)((ToulBar2::QueueComplexity) ? AC.pop_min() : AC.pop());
+            if (x->unassigned())
+                waveVars.push_back(x);
+        }
+        stable_sort(waveVars.begin(), waveVars.end(), [](EnumeratedVariable* x, EnumeratedVariable* y) { return x->getDACOrder() < y->getDACOrder(); });
+        waveStamp++;
+        waveCtrs.clear();
+        for (unsigned int i = 0; i < waveVars.size(); i++) {
+            ConstraintList* ctrs = waveVars[i]->getConstrs();
+            for (ConstraintList::iterator iter = ctrs->begin(); iter != ctrs->end(); ++iter) {
+                Constraint* ctr = (*iter).constr;
+                if ((*iter).scopeIndex >= 64) { // no room in waveIndexes
+                    nbWaveRemoves++;
+                    nbWaveRevisions++;
+                    ctr->remove((*iter).scopeIndex);
+                    continue;
+                }
+                if (ctr->waveStamp != waveStamp) {
+                    ctr->waveStamp = waveStamp;
+                    ctr->waveIndexes = 0;
+                    waveCtrs.push_back(ctr);
+                }
+                ctr->waveIndexes |= (uint64_t)1 << (*iter).scopeIndex;
+                nbWaveRemoves++;
+            }
+        }
+        for (unsigned int i = 0; i < waveCtrs.size(); i++) {
+            Constraint* ctr = waveCtrs[i];
+            if (ctr->connected()) {
+                nbWaveRevisions++;
+                ctr->removes(ctr->waveIndexes);
+            }
+            // Warning! propagateIncDec() necessary to transform inc/dec event into remove event
+            propagateIncDec(); // always examine inc/dec events before remove events
+        }
+    }
+}
+
 void WCSP::propagateDAC()
 {
     if (ToulBar2::verbose >= 2)
@@ -2741,7 +2920,6 @@ void WCSP::propagateTRWS()
     Cost bestUb = getUb();
     vector<int> orders[2] = { vector<int>(numberOfVariables()), vector<int>(numberOfVariables()) };
     vector<unsigned int> ranks[2] = { vector<unsigned int>(numberOfVariables()), vector<unsigned int>(numberOfVariables()) };
-    vector<Cost> tmpM(getMaxDomainSize(), numeric_limits<Cost>::max());
     vector<Value> bestPrimalVal(numberOfVariables(), 0);
     vector<int> bestPrimalVar(numberOfVariables(), 0);
     for (unsigned int i = 0; i < numberOfVariables(); ++i) {
@@ -2832,31 +3010,60 @@ void WCSP::propagateTRWS()
         Constraint* ctr = getCtr(i);
         if (ctr->connected() && ctr->isBinary()) {
             BinaryConstraint* binctr = static_cast<BinaryConstraint*>(ctr);
-            binctr->trwsM.clear();
+            fill(binctr->trwsM.begin(), binctr->trwsM.end(), MIN_COST);
         }
     }
     for (int i = 0; i < elimBinOrder; i++) {
         Constraint* ctr = elimBinConstrs[i];
         if (ctr->connected()) {
             BinaryConstraint* binctr = static_cast<BinaryConstraint*>(ctr);
-            binctr->trwsM.clear();
+            fill(binctr->trwsM.begin(), binctr->trwsM.end(), MIN_COST);
+        }
+    }
+
+    // Preprocessing: group the variables of each pass by levels, a variable being one level after its previous neighbors in the pass order
+    // (variables of the same level share no binary cost function, such that they can be processed in parallel with the same messages as in the pass order)
+    vector<vector<int>> levels[2];
+    for (int pass = 0; pass < 2; ++pass) {
+        vector<unsigned int> level(numberOfVariables(), 0);
+        for (unsigned int i = 0; i < numberOfVariables(); ++i) {
+            int v = orders[pass][i];
+            if (unassigned(v) && enumerated(v)) {
+                for (ConstraintList::iterator iter = getVar(v)->getConstrs()->begin(); iter != getVar(v)->getConstrs()->end(); ++iter) {
+                    Constraint* constraint = (*iter).constr;
+                    if (constraint->isBinary()) {
+                        BinaryConstraint* binctr = static_cast<BinaryConstraint*>(constraint);
+                        int u = binctr->getVarDiffFrom(getVar(v))->wcspIndex;
+                        if (ranks[pass][u] < ranks[pass][v])
+                            level[v] = max(level[v], level[u] + 1);
+                    }
+                }
+                if (level[v] >= levels[pass].size())
+                    levels[pass].resize(level[v] + 1);
+                levels[pass][level[v]].push_back(v);
+            }
         }
     }
 
     do {
         vector<int>& order = (forwardPass) ? orders[0] : orders[1];
         vector<unsigned int>& rank = (forwardPass) ? ranks[0] : ranks[1];
+        vector<vector<int>>& passLevels = (forwardPass) ? levels[0] : levels[1];
         ebound = MIN_COST;
-        for (unsigned int i = 0; i < numberOfVariables(); ++i) {
-            if (unassigned(order[i]) && enumerated(order[i])) {
+        for (unsigned int l = 0; l < passLevels.size(); ++l) {
+            vector<int>& vars = passLevels[l];
+            vector<Cost> deltas(vars.size(), MIN_COST);
+            parallelFor(vars.size(), ToulBar2::preprocessThreads, [this, &vars, &rank, &deltas](size_t i) {
                 if (ToulBar2::interrupted)
                     throw TimeOut();
-                EnumeratedVariable* s = static_cast<EnumeratedVariable*>(getVar(order[i]));
+                EnumeratedVariable* s = static_cast<EnumeratedVariable*>(getVar(vars[i]));
                 // step 1: normalize unary costs
                 vector<Cost> thetaHat(s->getDomainInitSize(), MIN_COST);
+                vector<Cost> mask(s->getDomainInitSize(), MIN_COST);
                 Cost delta = numeric_limits<Cost>::max();
                 for (EnumeratedVariable::iterator sIter = s->begin(); sIter != s->end(); ++sIter) {
                     unsigned int j = s->toIndex(*sIter);
+                    mask[j] = (Cost)-1;
                     thetaHat[j] = s->getCost(*sIter);
                     for (ConstraintList::iterator iter = s->getConstrs()->begin(); iter != s->getConstrs()->end(); ++iter) {
                         Constraint* constraint = (*iter).constr;
@@ -2872,41 +3079,34 @@ void WCSP::propagateTRWS()
                         unsigned int j = s->toIndex(*sIter);
                         thetaHat[j] -= delta;
                     }
-                    ebound += delta;
+                    deltas[i] += delta;
                 }
                 // step 2: message update
+                vector<Cost> theta(s->getDomainInitSize(), MIN_COST);
                 for (ConstraintList::iterator iter = s->getConstrs()->begin(); iter != s->getConstrs()->end(); ++iter) {
                     Constraint* constraint = (*iter).constr;
                     if (constraint->isBinary()) {
                         BinaryConstraint* binctr = static_cast<BinaryConstraint*>(constraint);
                         EnumeratedVariable* t = static_cast<EnumeratedVariable*>(binctr->getVarDiffFrom(s));
                         if (rank[s->wcspIndex] < rank[t->wcspIndex]) {
-                            std::function<Cost(unsigned int, unsigned int)> getCost1 = [binctr](unsigned int x, unsigned int y) { return binctr->getCost(x, y); };
-                            std::function<Cost(unsigned int, unsigned int)> getCost2 = [binctr](unsigned int y, unsigned int x) { return binctr->getCost(x, y); };
-                            auto getCost = (s == binctr->getVar(0)) ? getCost1 : getCost2;
-                            delta = numeric_limits<Cost>::max();
-                            tmpM.resize(max(s->getDomainInitSize(), t->getDomainInitSize()), numeric_limits<Cost>::max());
-                            for (EnumeratedVariable::iterator tIter = t->begin(); tIter != t->end(); ++tIter) {
-                                unsigned int k = t->toIndex(*tIter);
-                                tmpM[k] = numeric_limits<Cost>::max();
-                                for (EnumeratedVariable::iterator sIter = s->begin(); sIter != s->end(); ++sIter) {
-                                    unsigned int j = s->toIndex(*sIter);
-                                    tmpM[k] = min<Cost>(tmpM[k], static_cast<Cost>(trunc(s->getTRWSGamma() * thetaHat[j])) - binctr->trwsM[j] + getCost(j, k));
-                                }
-                                delta = min<Cost>(delta, tmpM[k]);
+                            for (EnumeratedVariable::iterator sIter = s->begin(); sIter != s->end(); ++sIter) {
+                                unsigned int j = s->toIndex(*sIter);
+                                theta[j] = static_cast<Cost>(trunc(s->getTRWSGamma() * thetaHat[j])) - binctr->trwsM[j];
                             }
-                            binctr->trwsM = tmpM;
+                            delta = binctr->messageTRWS(s, theta, mask, binctr->trwsM);
                             if (delta != MIN_COST) {
                                 for (EnumeratedVariable::iterator tIter = t->begin(); tIter != t->end(); ++tIter) {
                                     unsigned int k = t->toIndex(*tIter);
                                     binctr->trwsM[k] -= delta;
                                 }
-                                ebound += delta;
+                                deltas[i] += delta;
                             }
                         }
                     }
                 }
-            }
+            });
+            for (unsigned int i = 0; i < vars.size(); ++i)
+                ebound += deltas[i];
         }
         // step 3: compute ub
         if ((!forwardPass) && (ToulBar2::trwsNIterComputeUb > 0) && (nIteration > 0) && (nIteration % ToulBar2::trwsNIterComputeUb == 0)) {
@@ -3009,32 +3209,24 @@ void WCSP::propagateTRWS()
                         }
                     }
                 }
+                vector<Cost> mask(s->getDomainInitSize(), MIN_COST);
+                vector<Cost> theta(s->getDomainInitSize(), MIN_COST);
+                for (EnumeratedVariable::iterator sIter = s->begin(); sIter != s->end(); ++sIter)
+                    mask[s->toIndex(*sIter)] = (Cost)-1;
                 for (ConstraintList::iterator iter = s->getConstrs()->begin(); iter != s->getConstrs()->end(); ++iter) {
                     Constraint* constraint = (*iter).constr;
                     if (constraint->isBinary()) {
                         BinaryConstraint* binctr = static_cast<BinaryConstraint*>(constraint);
                         EnumeratedVariable* t = static_cast<EnumeratedVariable*>(binctr->getVarDiffFrom(s));
                         if (ranks[0][s->wcspIndex] < ranks[0][t->wcspIndex]) {
-                            std::function<Cost(unsigned int, unsigned int)> getCost1 = [binctr](unsigned int x, unsigned int y) { return binctr->getCostTRWS(x, y); };
-                            std::function<Cost(unsigned int, unsigned int)> getCost2 = [binctr](unsigned int y, unsigned int x) { return binctr->getCostTRWS(x, y); };
-                            auto getCost = (s == binctr->getVar(0)) ? getCost1 : getCost2;
-                            Cost minCost = numeric_limits<Cost>::max();
-                            tmpM.resize(max(s->getDomainInitSize(), t->getDomainInitSize()), numeric_limits<Cost>::max());
-                            for (EnumeratedVariable::iterator tIter = t->begin(); tIter != t->end(); ++tIter) {
-                                unsigned int k = t->toIndex(*tIter);
-                                tmpM[k] = numeric_limits<Cost>::max();
-                                for (EnumeratedVariable::iterator sIter = s->begin(); sIter != s->end(); ++sIter) {
-                                    tmpM[k] = min<Cost>(tmpM[k], getCost(*sIter, *tIter));
-                                }
-                                minCost = min<Cost>(minCost, tmpM[k]);
-                            }
+                            fill(theta.begin(), theta.end(), MIN_COST);
+                            Cost minCost = binctr->messageTRWS(s, theta, mask, binctr->trwsM);
                             for (EnumeratedVariable::iterator tIter = t->begin(); tIter != t->end(); ++tIter) {
                                 unsigned int k = t->toIndex(*tIter);
-                                tmpM[k] -= minCost;
+                                binctr->trwsM[k] -= minCost;
                             }
-                            binctr->trwsM = tmpM;
                             for (EnumeratedVariable::iterator tIter = t->begin(); tIter != t->end(); ++tIter) {
-                                binctr->projectTRWS(t, *tIter, binctr->trwsM[t->toValue(*tIter)]);
+                                binctr->projectTRWS(t, *tIter, binctr->trwsM[t->toIndex(*tIter)]);
                             }
                             minCost = binctr->normalizeTRWS();
                             delta += minCost;
@@ -3089,12 +3281,40 @@ void WCSP::propagateDEE()
     if (ToulBar2::verbose >= 2)
         cout << "DEEQueue size: " << DEE.getSize() << endl;
     assert(NC.empty());
+    // in preprocessing, matrices of the next variables in the queue are computed in parallel and used if still valid when popped
+    int nbThreads = (Store::getDepth() == 0) ? ToulBar2::preprocessThreads : 1;
+    vector<Variable*> next;
+    vector<DEEMatrix> matrices;
+    unsigned int nbUnassigned = 0;
+    DEEMatrix matrix;
     while (!DEE.empty()) {
         if (ToulBar2::interrupted)
             throw TimeOut();
         EnumeratedVariable* x = (EnumeratedVariable*)DEE.pop();
         if (x->unassigned()) {
-            if (ToulBar2::DEE_ >= 3 || (ToulBar2::DEE_ == 2 && Store::getDepth() == 0)) {
+            if ((ToulBar2::DEE_ >= 3 || (ToulBar2::DEE_ == 2 && Store::getDepth() == 0)) && ToulBar2::DEEMatrix && x->canUseDEEMatrix()) {
+                size_t pos = std::find(next.begin(), next.end(), x) - next.begin();
+                if (pos == next.size() && nbThreads > 1) {
+                    DEE.top(next, 2 * nbThreads - 1);
+                    next.insert(next.begin(), x);
+                    for (size_t i = 1; i < next.size(); i++) {
+                        if (next[i]->assigned() || !((EnumeratedVariable*)next[i])->canUseDEEMatrix())
+                            next[i] = NULL;
+                    }
+                    matrices.resize(next.size());
+                    parallelFor(next.size(), nbThreads, [&next, &matrices](size_t i) { if (next[i]) ((EnumeratedVariable*)next[i])->computeDEEMatrix(matrices[i]); });
+                    nbUnassigned = numberOfUnassignedVariables();
+                    pos = 0;
+                }
+                if (pos < next.size() && (pos == 0 || numberOfUnassignedVariables() == nbUnassigned) && x->isDEEMatrixValid(matrices[pos])) {
+                    x->propagateDEE(matrices[pos]);
+                } else {
+                    x->computeDEEMatrix(matrix);
+                    x->propagateDEE(matrix);
+                }
+                if (pos < next.size())
+                    next[pos] = NULL;
+            } else if (ToulBar2::DEE_ >= 3 || (ToulBar2::DEE_ == 2 && Store::getDepth() == 0)) {
                 for (EnumeratedVariable::iterator itera = x->begin(); itera != x->end(); ++itera) {
                     for (EnumeratedVariable::iterator iterb = x->lower_bound(*itera + 1); iterb != x->end(); ++iterb) {
                         assert(x->canbe(*itera));
@@ -3422,6 +3642,7 @@ void WCSP::initElimConstrs()
 }
 
 // Function that adds a new binary constraint from the pool of fake constraints
+// its cost table is never shrunk on backtrack, the first elimination using a pool slot in search being the only one to allocate it
 BinaryConstraint* WCSP::newBinaryConstr(EnumeratedVariable* x, EnumeratedVariable* y, Constraint* from1, Constraint* from2)
 {
     unsigned int newIndex = (int)elimBinOrder;
@@ -3446,6 +3667,7 @@ BinaryConstraint* WCSP::newBinaryConstr(EnumeratedVariable* x, EnumeratedVariabl
 
 // warning! you must create beforehand three binary constraints in fake pool (elimBinConstrs)
 // if they do not exist in the main pool (constrs)
+// its cost table is never shrunk on backtrack as for newBinaryConstr
 TernaryConstraint* WCSP::newTernaryConstr(EnumeratedVariable* x, EnumeratedVariable* y, EnumeratedVariable* z, Constraint* from1)
 {
     unsigned int newIndex = (int)elimTernOrder;
@@ -3883,6 +4105,68 @@ void WCSP::project(Constraint*& ctr_inout, EnumeratedVariable* var)
     }
 }
 
+/// \brief sums all the cost functions of \a var at once in a new n-ary cost function with a dense table, \a var being its last variable (bucket elimination)
+/// \return NULL if one of them is not a binary, ternary or n-ary cost function in extension with a dense table or a finite default cost,
+/// if their scopes have less than NARYPROJECTIONSIZE other variables (see WCSP::sum), or if the table would exceed ToulBar2::elimSpaceMaxMB
+Constraint* WCSP::sumBucket(EnumeratedVariable* var)
+{
+    Cost Top = getUb();
+    vector<Constraint*> bucket;
+    set<int> others;
+    Double size = var->getDomainInitSize();
+    for (ConstraintList::iterator it = var->getConstrs()->begin(); it != var->getConstrs()->end(); ++it) {
+        Constraint* ctr = (*it).constr;
+        if (!ctr->isBinary() && !ctr->isTernary() && !(ctr->isNary() && (((NaryConstraint*)ctr)->dense() || ((NaryConstraint*)ctr)->getDefCost() < Top)))
+            return NULL;
+        bucket.push_back(ctr);
+        for (int i = 0; i < ctr->arity(); i++) {
+            EnumeratedVariable* x = (EnumeratedVariable*)ctr->getVar(i);
+            if (x != var && others.insert(x->wcspIndex).second)
+                size *= x->getDomainInitSize();
+        }
+    }
+    if ((int)others.size() < NARYPROJECTIONSIZE)
+        return NULL;
+    if (ToulBar2::elimSpaceMaxMB && size * sizeof(Cost) > (Double)ToulBar2::elimSpaceMaxMB * 1024. * 1024.)
+        return NULL;
+    if (ToulBar2::verbose >= 1)
+        cout << endl
+             << "Sum of " << bucket.size() << " cost functions on " << others.size() + 1 << " variables" << endl;
+
+    for (unsigned int k = 0; k < bucket.size(); k++)
+        bucket[k]->deconnect();
+    int arity = others.size() + 1;
+    int scope[arity];
+    int i = 0;
+    for (set<int>::iterator it = others.begin(); it != others.end(); ++it)
+        scope[i++] = *it;
+    scope[i] = var->wcspIndex;
+    int ctrIndex = postNaryConstraintBegin(scope, arity, Top, (Long)size);
+    NaryConstraint* nary = (NaryConstraint*)getCtr(ctrIndex);
+    assert(nary->isNary());
+    nary->fillFilters();
+    nary->expand();
+    if (nary->dense()) {
+        nary->sumDense(bucket);
+    } else { // not enough memory for the table
+        String tuple;
+        Cost cost;
+        nary->firstlex();
+        while (nary->nextlex(tuple, cost)) {
+            cost = MIN_COST;
+            for (unsigned int k = 0; k < bucket.size() && cost < Top; k++)
+                cost += bucket[k]->evalsubstr(tuple, nary);
+            if (cost < Top)
+                nary->setTuple(tuple, cost);
+        }
+    }
+    nary->propagate();
+    if (ToulBar2::verbose >= 1)
+        cout << endl
+             << "Has result: " << *nary << endl;
+    return nary;
+}
+
 void WCSP::variableElimination(EnumeratedVariable* var)
 {
     int degree = var->getTrueDegree();
@@ -3902,6 +4186,13 @@ void WCSP::variableElimination(EnumeratedVariable* var)
         Constraint* csum = c1;
         Constraint* csumcopy = NULL;
 
+        Constraint* cbucket = (var->getDegree() > 1) ? sumBucket(var) : NULL;
+        if (cbucket) {
+            csum = cbucket;
+            if (getTreeDec()) {
+                csum->setCluster(var->getCluster());
+            }
+        }
         while (var->getDegree() > 1) {
             it1 = var->getConstrs()->begin();
             it2 = var->getConstrs()->rbegin();
@@ -4362,15 +4653,18 @@ void WCSP::setDACOrder(vector<int>& order)
     }
     propagate();
     // recompute all tightness: too slow???
+    vector<Constraint*> ctrs;
     for (unsigned int i = 0; i < constrs.size(); i++)
         if (constrs[i]->connected())
-            constrs[i]->computeTightness();
+            ctrs.push_back(constrs[i]);
     for (int i = 0; i < elimBinOrder; i++)
         if (elimBinConstrs[i]->connected())
-            elimBinConstrs[i]->computeTightness();
+            ctrs.push_back(elimBinConstrs[i]);
     for (int i = 0; i < elimTernOrder; i++)
         if (elimTernConstrs[i]->connected())
-            elimTernConstrs[i]->computeTightness();
+            ctrs.push_back(elimTernConstrs[i]);
+    // the median of weighted tightness uses the shared random generator
+    parallelFor(ctrs.size(), (ToulBar2::weightedTightness == 2) ? 1 : ToulBar2::preprocessThreads, [&ctrs](size_t i) { ctrs[i]->computeTightness(); });
 }
 
 // -----------------------------------------------------------
@@ -61,6 +61,12 @@ class WCSP FINAL : public WeightedCSP {
     bool objectiveChanged; ///< flag if lb or ub has changed (NC propagation needs to be done)
     Long nbNodes; ///< current number of calls to propagate method (roughly equal to number of search nodes), used as a time-stamp by Queue methods
     Long nbDEE; ///< number of value removals due to DEE
+    Long waveStamp; ///< current wave of propagateACWaves
+    vector<EnumeratedVariable*> waveVars; ///< variables of the current wave
+    vector<Constraint*> waveCtrs; ///< cost functions to be revised in the current wave
+    Long nbWaveRemoves; ///< number of (variable, cost function) revisions requested by the waves
+    Long nbWaveRevisions; ///< number of cost function revisions done by the waves
+    vector<map<Value, vector<Value>>> interchangeableValues; ///< for each variable, values removed by mergeInterchangeableValues indexed by their remaining representative value
     Constraint* lastConflictConstr; ///< hook for last conflict variable heuristic
     int maxdomainsize; ///< maximum initial domain size found in all variables
     vector<GlobalConstraint*> globalconstrs; ///< a list of all original global constraints (also inserted in constrs)
@@ -544,6 +550,9 @@ public:
     void propagateNC(); ///< \brief removes forbidden values
     void propagateIncDec(); ///< \brief ensures unary bound arc consistency supports (remove forbidden domain bounds)
     void propagateAC(); ///< \brief ensures unary and binary and ternary arc consistency supports
+    void propagateACWaves(); ///< \brief same as propagateAC with each cost function revised once per wave of variables (see ToulBar2::propagationWaves)
+    Long getNbWaveRemoves() const { return nbWaveRemoves; }
+    Long getNbWaveRevisions() const { return nbWaveRevisions; }
     void propagateDAC(); ///< \brief ensures unary and binary and ternary directed arc consistency supports
     void propagateTRWS(); ///< \brief iterates TRW-S until convergence
     void fillEAC2();
@@ -560,6 +569,9 @@ public:
     /// \warning to be done \b only before the search
     void preprocessing();
 
+    void mergeInterchangeableValues();
+    const vector<Value>& getInterchangeableValues(int varIndex, Value value) const;
+
     // -----------------------------------------------------------
     // Methods for Variable Elimination
 
@@ -584,6 +596,7 @@ public:
     void restoreSolution(Cluster* c = NULL);
 
     Constraint* sum(Constraint* ctr1, Constraint* ctr2);
+    Constraint* sumBucket(EnumeratedVariable* var);
     void project(Constraint*& ctr_inout, EnumeratedVariable* var);
     void variableElimination(EnumeratedVariable* var);
 
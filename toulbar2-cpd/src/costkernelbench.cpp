@@ -0,0 +1,120 @@
+/**
+ * Microbenchmark of the dense minimum kernels used by binary cost functions
+ *
+ * Compares the iteration over domains (level 0) with the portable (1), AVX2 (2), and AVX-512 (3) kernels,
+ * first on the kernels alone, then on soft arc consistency after random assignments in a complete binary problem.
+ *
+ * usage: costkernelbench [domain size (20)] [number of variables (30)] [number of assignments (1000)]
+ */
+
+#include "toulbar2lib.hpp"
+#include "core/tb2costkernels.hpp"
+#include "core/tb2domain.hpp"
+#include <stdlib.h>
+
+static Cost minCostDomain(const Cost* row, unsigned int stride, const vector<Cost>& adj, const vector<Value>& domain, unsigned int& argmin)
+{
+    Cost minCost = numeric_limits<Cost>::max();
+    for (unsigned int k = 0; k < domain.size(); k++) {
+        Cost cost = row[domain[k] * stride] - adj[domain[k]];
+        if (cost < minCost) {
+            minCost = cost;
+            argmin = domain[k];
+        }
+    }
+    return minCost;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int d = (argc > 1) ? atoi(argv[1]) : 20;
+    unsigned int n = (argc > 2) ? atoi(argv[2]) : 30;
+    int nbAssigns = (argc > 3) ? atoi(argv[3]) : 1000;
+    int maxLevel = selectCostKernels();
+
+    // kernels alone: minimum of each row and column of a d x d matrix with 3/4 of the values in the domain
+    {
+        mysrand(1);
+        vector<Cost> matrix(d * d), adj(d), mask(d);
+        vector<Value> domain;
+        for (unsigned int i = 0; i < d * d; i++)
+            matrix[i] = randomCost(0, 100);
+        for (unsigned int j = 0; j < d; j++) {
+            adj[j] = randomCost(0, 10);
+            mask[j] = (myrand() % 4) ? -1 : 0;
+            if (mask[j])
+                domain.push_back(j);
+        }
+        int repeat = max(1, (int)(20000000 / (d * d)));
+        for (int level = COSTKERNELS_NONE; level <= maxLevel; level++) {
+            Long checksum = 0;
+            unsigned int argmin = 0;
+            double start = cpuTime();
+            if (level == COSTKERNELS_NONE) {
+                for (int r = 0; r < repeat; r++) {
+                    for (unsigned int i = 0; i < d; i++) {
+                        checksum += minCostDomain(&matrix[i * d], 1, adj, domain, argmin) + argmin;
+                        checksum += minCostDomain(&matrix[i], d, adj, domain, argmin) + argmin;
+                    }
+                }
+            } else {
+                selectCostKernels(level);
+                for (int r = 0; r < repeat; r++) {
+                    for (unsigned int i = 0; i < d; i++) {
+                        checksum += rowMinCost(&matrix[i * d], &adj[0], &mask[0], d, argmin) + argmin;
+                        checksum += columnMinCost(&matrix[i], d, &adj[0], &mask[0], d, argmin) + argmin;
+                    }
+                }
+            }
+            cout << "kernels level " << level << ": " << cpuTime() - start << " seconds (checksum " << checksum << ")" << endl;
+        }
+    }
+
+    // soft arc consistency after random assignments
+    tb2init();
+    ToulBar2::verbose = -1;
+    initCosts();
+    for (int level = COSTKERNELS_NONE; level <= maxLevel; level++) {
+        selectCostKernels(level);
+        mysrand(1);
+        WeightedCSPSolver* solver = WeightedCSPSolver::makeWeightedCSPSolver(MAX_COST);
+        WeightedCSP* wcsp = solver->getWCSP();
+        for (unsigned int i = 0; i < n; i++)
+            wcsp->makeEnumeratedVariable(to_string(i), 0, d - 1);
+        vector<Cost> costs(d * d);
+        for (unsigned int i = 0; i < n; i++) {
+            for (unsigned int j = i + 1; j < n; j++) {
+                for (unsigned int k = 0; k < d * d; k++)
+                    costs[k] = randomCost(0, 100);
+                wcsp->postBinaryConstraint(i, j, costs);
+            }
+        }
+        wcsp->sortConstraints();
+        wcsp->propagate();
+        Long checksum = 0;
+        double start = cpuTime();
+        for (int a = 0; a < nbAssigns; a++) {
+            int var = myrand() % n;
+            Value value = myrand() % d;
+            Store::store();
+            try {
+                wcsp->assign(var, value);
+                wcsp->propagate();
+                checksum += wcsp->getLb();
+            } catch (Contradiction) {
+                wcsp->whenContradiction();
+            }
+            Store::restore();
+        }
+        cout << "propagation level " << level << ": " << cpuTime() - start << " seconds (checksum " << checksum << ")" << endl;
+        delete solver;
+    }
+    return 0;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
@@ -0,0 +1,157 @@
+/**
+ * Unit check of the dense minimum kernels used by binary cost functions
+ *
+ * Each kernel level must give the same minimum and the same support as a left-to-right scan:
+ * first on random rows and columns of every size and encoding (with many ties),
+ * then on soft arc consistency of random binary problems whose domains are permuted by permuteDomain,
+ * where the lower bound, unary costs and binary supports must be identical to the iteration over domains (level 0).
+ *
+ * usage: costkernelcheck [number of problems (10)]
+ * \return 0 if all the levels supported by the processor agree, 1 otherwise
+ */
+
+#include "toulbar2lib.hpp"
+#include "core/tb2costkernels.hpp"
+#include "core/tb2wcsp.hpp"
+#include "core/tb2binconstr.hpp"
+#include <stdlib.h>
+
+template <class T>
+static Cost minCostScan(const T* costs, unsigned int stride, Cost base, const vector<Cost>& adj, const vector<Cost>& mask, unsigned int size, unsigned int& argmin)
+{
+    Cost minCost = numeric_limits<Cost>::max();
+    argmin = size;
+    for (unsigned int j = 0; j < size; j++) {
+        if (mask[j] && base + (Cost)costs[(size_t)j * stride] - adj[j] < minCost) {
+            minCost = base + (Cost)costs[(size_t)j * stride] - adj[j];
+            argmin = j;
+        }
+    }
+    return minCost;
+}
+
+/// \brief compares the row and column kernels of one encoding with minCostScan on a random \a d x \a d matrix
+template <class T>
+static int checkKernels(CostWidth width, Cost base, unsigned int d, int level)
+{
+    int errors = 0;
+    vector<T> matrix(d * d + 2); // narrow columns can be read two bytes after the last element
+    vector<Cost> adj(d), mask(d);
+    for (unsigned int i = 0; i < d * d; i++)
+        matrix[i] = (T)randomCost(0, 3);
+    for (unsigned int j = 0; j < d; j++) {
+        adj[j] = randomCost(0, 2);
+        mask[j] = (myrand() % 4) ? -1 : 0;
+    }
+    for (unsigned int i = 0; i < d; i++) {
+        unsigned int argmin = 0, argminScan = 0;
+        Cost minCost = rowMinCostKernels[width](&matrix[i * d], base, &adj[0], &mask[0], d, argmin);
+        Cost minCostScanned = minCostScan(&matrix[i * d], 1, base, adj, mask, d, argminScan);
+        if (minCost != minCostScanned || argmin != argminScan) {
+            cout << "level " << level << " width " << width << " size " << d << " row " << i << ": " << minCost << " at " << argmin << " instead of " << minCostScanned << " at " << argminScan << endl;
+            errors++;
+        }
+        minCost = columnMinCostKernels[width](&matrix[i], d, base, &adj[0], &mask[0], d, argmin);
+        minCostScanned = minCostScan(&matrix[i], d, base, adj, mask, d, argminScan);
+        if (minCost != minCostScanned || argmin != argminScan) {
+            cout << "level " << level << " width " << width << " size " << d << " column " << i << ": " << minCost << " at " << argmin << " instead of " << minCostScanned << " at " << argminScan << endl;
+            errors++;
+        }
+    }
+    return errors;
+}
+
+/// \brief lower bound, unary costs and binary supports after propagating a random binary problem with permuted domains and some removed values
+static vector<Cost> propagationState(int seed, unsigned int n, unsigned int d)
+{
+    vector<Cost> state;
+    mysrand(seed);
+    WeightedCSPSolver* solver = WeightedCSPSolver::makeWeightedCSPSolver(MAX_COST);
+    WCSP* wcsp = (WCSP*)solver->getWCSP();
+    for (unsigned int i = 0; i < n; i++)
+        wcsp->makeEnumeratedVariable(to_string(i), 0, d - 1);
+    vector<Cost> costs(d * d);
+    for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = i + 1; j < n; j++) {
+            for (unsigned int k = 0; k < d * d; k++)
+                costs[k] = randomCost(0, 4);
+            wcsp->postBinaryConstraint(i, j, costs);
+        }
+    }
+    wcsp->sortConstraints();
+    for (unsigned int i = 0; i < n; i++)
+        ((EnumeratedVariable*)wcsp->getVar(i))->permuteDomain(d);
+    try {
+        wcsp->propagate();
+        for (unsigned int i = 0; i < n; i++) {
+            for (unsigned int k = 0; k < d / 4; k++) {
+                Value value = myrand() % d;
+                if (wcsp->canbe(i, value) && wcsp->getDomainSize(i) > 1)
+                    wcsp->remove(i, value);
+            }
+        }
+        wcsp->propagate();
+    } catch (Contradiction) {
+        wcsp->whenContradiction();
+        state.push_back(-1);
+    }
+    state.push_back(wcsp->getLb());
+    for (unsigned int i = 0; i < n; i++) {
+        EnumeratedVariable* x = (EnumeratedVariable*)wcsp->getVar(i);
+        for (EnumeratedVariable::iterator iter = x->begin(); iter != x->end(); ++iter)
+            state.push_back(x->getCost(*iter));
+    }
+    for (unsigned int c = 0; c < wcsp->numberOfConstraints(); c++) {
+        BinaryConstraint* ctr = (BinaryConstraint*)wcsp->getCtr(c);
+        for (int k = 0; k < 2; k++) {
+            EnumeratedVariable* x = (EnumeratedVariable*)ctr->getVar(k);
+            for (EnumeratedVariable::iterator iter = x->begin(); iter != x->end(); ++iter)
+                state.push_back(ctr->getSupport(x, *iter));
+        }
+    }
+    delete solver;
+    return state;
+}
+
+int main(int argc, char* argv[])
+{
+    int nbProblems = (argc > 1) ? atoi(argv[1]) : 10;
+    int maxLevel = selectCostKernels();
+    int errors = 0;
+
+    for (int level = COSTKERNELS_SCALAR; level <= maxLevel; level++) {
+        selectCostKernels(level);
+        mysrand(1);
+        for (unsigned int d = 1; d <= 40; d++) {
+            errors += checkKernels<uint16_t>(COSTWIDTH_16, 1000, d, level);
+            errors += checkKernels<uint32_t>(COSTWIDTH_32, 100000, d, level);
+            errors += checkKernels<Cost>(COSTWIDTH_PLAIN, MIN_COST, d, level);
+        }
+    }
+
+    tb2init();
+    ToulBar2::verbose = -1;
+    initCosts();
+    for (int p = 0; p < nbProblems; p++) {
+        unsigned int d = 8 + 3 * p;
+        selectCostKernels(COSTKERNELS_NONE);
+        vector<Cost> scanned = propagationState(p, 10, d);
+        for (int level = COSTKERNELS_SCALAR; level <= maxLevel; level++) {
+            selectCostKernels(level);
+            if (propagationState(p, 10, d) != scanned) {
+                cout << "level " << level << " problem " << p << ": different lower bound, unary costs or supports after propagation" << endl;
+                errors++;
+            }
+        }
+    }
+
+    cout << "costkernelcheck: levels 0 to " << maxLevel << ", " << errors << " error(s)" << endl;
+    return (errors > 0) ? 1 : 0;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
@@ -56,7 +56,8 @@ int Solver::getVarMinDomainDivMaxDegreeRandomized(Cluster* cluster)
     int varIndex = -1;
     Cost worstUnaryCost = MIN_COST;
     double best = MAX_VAL - MIN_VAL;
-    int ties[cluster->getNbVars()];
+    ScratchScope scope(scratch);
+    int* ties = scratch.alloc<int>(cluster->getNbVars());
     int nbties = 0;
 
     for (TVars::iterator iter = cluster->beginVars(); iter != cluster->endVars(); ++iter) {
@@ -120,7 +121,8 @@ int Solver::getVarMinDomainDivMaxDegreeLastConflictRandomized(Cluster* cluster)
     int varIndex = -1;
     Cost worstUnaryCost = MIN_COST;
     double best = MAX_VAL - MIN_VAL;
-    int ties[cluster->getNbVars()];
+    ScratchScope scope(scratch);
+    int* ties = scratch.alloc<int>(cluster->getNbVars());
     int nbties = 0;
 
     for (TVars::iterator iter = cluster->beginVars(); iter != cluster->endVars(); ++iter) {
@@ -159,7 +161,8 @@ int Solver::getVarMinDomainDivMaxWeightedDegree(Cluster* cluster)
             Cost unarymediancost = MIN_COST;
             int domsize = wcsp->getDomainSize(*iter);
             if (ToulBar2::weightedTightness) {
-                ValueCost array[domsize];
+                ScratchScope scope(scratch);
+                ValueCost* array = scratch.alloc<ValueCost>(domsize);
                 wcsp->getEnumDomainAndCost(*iter, array);
                 unarymediancost = stochastic_selection<ValueCost>(array, 0, domsize - 1, domsize / 2).cost;
             }
@@ -183,7 +186,8 @@ int Solver::getVarMinDomainDivMaxWeightedDegreeRandomized(Cluster* cluster)
     int varIndex = -1;
     Cost worstUnaryCost = MIN_COST;
     double best = MAX_VAL - MIN_VAL;
-    int ties[cluster->getNbVars()];
+    ScratchScope scope(scratch);
+    int* ties = scratch.alloc<int>(cluster->getNbVars());
     int nbties = 0;
 
     for (TVars::iterator iter = cluster->beginVars(); iter != cluster->endVars(); ++iter) {
@@ -191,7 +195,8 @@ int Solver::getVarMinDomainDivMaxWeightedDegreeRandomized(Cluster* cluster)
             Cost unarymediancost = MIN_COST;
             int domsize = wcsp->getDomainSize(*iter);
             if (ToulBar2::weightedTightness) {
-                ValueCost array[domsize];
+                ScratchScope scope(scratch);
+                ValueCost* array = scratch.alloc<ValueCost>(domsize);
                 wcsp->getEnumDomainAndCost(*iter, array);
                 unarymediancost = stochastic_selection<ValueCost>(array, 0, domsize - 1, domsize / 2).cost;
             }
@@ -233,7 +238,8 @@ int Solver::getVarMinDomainDivMaxWeightedDegreeLastConflict(Cluster* cluster)
             Cost unarymediancost = MIN_COST;
             int domsize = wcsp->getDomainSize(*iter);
             if (ToulBar2::weightedTightness) {
-                ValueCost array[domsize];
+                ScratchScope scope(scratch);
+                ValueCost* array = scratch.alloc<ValueCost>(domsize);
                 wcsp->getEnumDomainAndCost(*iter, array);
                 unarymediancost = stochastic_selection<ValueCost>(array, 0, domsize - 1, domsize / 2).cost;
             }
@@ -262,7 +268,8 @@ int Solver::getVarMinDomainDivMaxWeightedDegreeLastConflictRandomized(Cluster* c
     int varIndex = -1;
     Cost worstUnaryCost = MIN_COST;
     double best = MAX_VAL - MIN_VAL;
-    int ties[cluster->getNbVars()];
+    ScratchScope scope(scratch);
+    int* ties = scratch.alloc<int>(cluster->getNbVars());
     int nbties = 0;
 
     for (TVars::iterator iter = cluster->beginVars(); iter != cluster->endVars(); ++iter) {
@@ -270,7 +277,8 @@ int Solver::getVarMinDomainDivMaxWeightedDegreeLastConflictRandomized(Cluster* c
             Cost unarymediancost = MIN_COST;
             int domsize = wcsp->getDomainSize(*iter);
             if (ToulBar2::weightedTightness) {
-                ValueCost array[domsize];
+                ScratchScope scope(scratch);
+                ValueCost* array = scratch.alloc<ValueCost>(domsize);
                 wcsp->getEnumDomainAndCost(*iter, array);
                 unarymediancost = stochastic_selection<ValueCost>(array, 0, domsize - 1, domsize / 2).cost;
             }
@@ -0,0 +1,171 @@
+/*
+ * **************** Checkpoint and resume of hybrid best-first search *******************
+ *
+ * The search state at the root of HBFS (without tree decomposition) is fully
+ * described by the current primal bound and its solution, the open nodes,
+ * and the choice points they refer to. Adding the heuristic state (weighted
+ * degrees, last conflict variable, best values) allows to continue the
+ * search as if it had never been interrupted, provided the same problem is
+ * loaded and preprocessed with the same options.
+ */
+
+#include "tb2solver.hpp"
+#include "core/tb2wcsp.hpp"
+
+static const char* CheckpointHeader = "toulbar2-checkpoint";
+static const int CheckpointVersion = 1;
+
+/// \brief saves the current HBFS state into ToulBar2::checkpointFile
+/// \param rootLb lower bound of the problem at the root of hybrid best-first search (used to check the problem is the same when resuming)
+/// \note the file is first written under a temporary name and then renamed in order to be replaced atomically
+void Solver::writeCheckpoint(Cost rootLb)
+{
+    assert(cp && open);
+    string tmpname = ToulBar2::checkpointFile + ".tmp";
+    ofstream file(tmpname.c_str());
+    if (!file) {
+        cerr << "Could not write checkpoint file: " << tmpname << endl;
+        return;
+    }
+    unsigned int n = wcsp->numberOfVariables();
+    unsigned int m = wcsp->numberOfConstraints();
+    file << CheckpointHeader << " " << CheckpointVersion << endl;
+    file << "problem " << n << " " << m << " " << rootLb << " " << wcsp->getDomainSizeSum() << endl;
+
+    Cost solutionCost = MAX_COST;
+    const vector<Value>& solution = wcsp->getSolution(&solutionCost);
+    bool hasSolution = (solutionCost < MAX_COST && solution.size() == n);
+    file << "ub " << wcsp->getUb() << " " << hasSolution;
+    if (hasSolution) {
+        for (unsigned int i = 0; i < n; i++)
+            file << " " << solution[i];
+    }
+    file << endl;
+
+    file << "bounds " << initialLowerBound << " " << globalLowerBound << " " << globalUpperBound << endl;
+    file << "search " << nbNodes << " " << nbBacktracks << " " << nbHybrid << " " << nbHybridContinue << " " << nbHybridNew << " " << nbRecomputationNodes << " " << ToulBar2::hbfs << " " << ToulBar2::hbfsGlobalLimit << " " << lastConflictVar << endl;
+
+    file << "bestvalues";
+    for (unsigned int i = 0; i < n; i++)
+        file << " " << wcsp->getBestValue(i);
+    file << endl;
+    file << "weights";
+    for (unsigned int i = 0; i < m; i++)
+        file << " " << ((WCSP*)wcsp)->getCtr(i)->getConflictWeight();
+    file << endl;
+
+    file << "choicepoints " << cp->size() << " " << cp->start << " " << cp->stop << endl;
+    for (CPStore::iterator iter = cp->begin(); iter != cp->end(); ++iter) {
+        file << iter->op << " " << iter->varIndex << " " << iter->value << " " << iter->reverse << endl;
+    }
+    file << "open " << open->size() << " " << open->getClosedNodesLb() << " " << open->getUb() << endl;
+    for (priority_queue<OpenNode>::container_type::iterator iter = open->begin(); iter != open->end(); ++iter) {
+        file << iter->getCost() << " " << iter->first << " " << iter->last << endl;
+    }
+    file << "end" << endl;
+    file.close();
+    if (!file || rename(tmpname.c_str(), ToulBar2::checkpointFile.c_str()) != 0) {
+        cerr << "Could not write checkpoint file: " << ToulBar2::checkpointFile << endl;
+        return;
+    }
+    checkpointLastTime = realTime();
+    if (ToulBar2::verbose >= 1)
+        cout << "Checkpoint saved with " << open->size() << " open nodes and " << cp->size() << " choice points (" << nbBacktracks << " backtracks, " << nbNodes << " nodes)" << endl;
+}
+
+/// \brief restores the HBFS state saved in ToulBar2::checkpointFile (done at most once)
+/// \param rootLb lower bound of the problem at the root of hybrid best-first search
+/// \return false if there is no valid checkpoint to resume from, and the search starts from scratch
+/// \warning must be called at the root of hybrid best-first search, after creating empty \c cp and \c open
+bool Solver::readCheckpoint(Cost rootLb)
+{
+    ToulBar2::resume = false;
+    ifstream file(ToulBar2::checkpointFile.c_str());
+    if (!file) {
+        if (ToulBar2::verbose >= 0)
+            cout << "No checkpoint file " << ToulBar2::checkpointFile << " found, starting from scratch." << endl;
+        return false;
+    }
+    string keyword;
+    int version = 0;
+    unsigned int n = 0, m = 0, domsum = 0;
+    Cost lb = MIN_COST;
+    file >> keyword >> version;
+    if (keyword != CheckpointHeader || version != CheckpointVersion) {
+        cerr << "Error: wrong checkpoint file format: " << ToulBar2::checkpointFile << endl;
+        exit(EXIT_FAILURE);
+    }
+    file >> keyword >> n >> m >> lb >> domsum;
+    if (keyword != "problem" || n != wcsp->numberOfVariables() || m != wcsp->numberOfConstraints() || lb != rootLb || domsum != wcsp->getDomainSizeSum()) {
+        cerr << "Error: checkpoint file " << ToulBar2::checkpointFile << " does not correspond to the current problem (check the problem file and the preprocessing options)." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Cost ub = MAX_COST;
+    bool hasSolution = false;
+    vector<Value> solution(n, 0);
+    file >> keyword >> ub >> hasSolution;
+    if (hasSolution) {
+        for (unsigned int i = 0; i < n; i++)
+            file >> solution[i];
+    }
+    file >> keyword >> initialLowerBound >> globalLowerBound >> globalUpperBound;
+    file >> keyword >> nbNodes >> nbBacktracks >> nbHybrid >> nbHybridContinue >> nbHybridNew >> nbRecomputationNodes >> ToulBar2::hbfs >> ToulBar2::hbfsGlobalLimit >> lastConflictVar;
+
+    file >> keyword;
+    for (unsigned int i = 0; i < n; i++) {
+        Value value = 0;
+        file >> value;
+        wcsp->setBestValue(i, value);
+    }
+    file >> keyword;
+    for (unsigned int i = 0; i < m; i++) {
+        Long weight = 0;
+        file >> weight;
+        Constraint* ctr = ((WCSP*)wcsp)->getCtr(i);
+        ctr->incConflictWeight(weight - ctr->getConflictWeight());
+    }
+
+    size_t size = 0;
+    file >> keyword >> size >> cp->start >> cp->stop;
+    cp->reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        int op = CP_ASSIGN, varIndex = 0;
+        Value value = 0;
+        bool reverse = false;
+        file >> op >> varIndex >> value >> reverse;
+        cp->push_back(ChoicePoint((ChoicePointOp)op, varIndex, value, reverse));
+    }
+    Cost clb = MIN_COST, cub = MAX_COST;
+    file >> keyword >> size >> clb >> cub;
+    *open = OpenList(clb, cub);
+    for (size_t i = 0; i < size; i++) {
+        Cost cost = MIN_COST;
+        ptrdiff_t first = 0, last = 0;
+        file >> cost >> first >> last;
+        open->push(OpenNode(cost, first, last));
+    }
+    file >> keyword;
+    if (!file || keyword != "end") {
+        cerr << "Error: truncated checkpoint file: " << ToulBar2::checkpointFile << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (ToulBar2::verbose >= 0)
+        cout << "Resume from checkpoint with " << open->size() << " open nodes and " << cp->size() << " choice points (" << nbBacktracks << " backtracks, " << nbNodes << " nodes)" << endl;
+    if (hasSolution && ub < wcsp->getUb()) {
+        try {
+            replaySolution(&solution[0]);
+        } catch (NbBacktracksOut) {
+        }
+    }
+    wcsp->updateUb(ub);
+    return true;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
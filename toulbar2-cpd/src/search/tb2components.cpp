@@ -0,0 +1,247 @@
+/*
+ * **************** Dynamic decomposition into independent subproblems *******************
+ *
+ * When the constraint graph restricted to the unassigned variables becomes
+ * disconnected, the remaining problem is the sum of independent subproblems
+ * (plus the current lower bound). Each subproblem is solved separately by
+ * depth-first branch and bound, and their optimal assignments are combined
+ * into a single solution. The optimal assignment of a subproblem depends only
+ * on the current domains of its variables and on the values of its assigned
+ * neighbors in the constraint graph, so it is cached under this key.
+ *
+ * During the separate resolutions, the global upper bound is lifted such
+ * that node consistency does not prune values in the other subproblems,
+ * which makes the lower bound increase exactly the cost of the current
+ * subproblem. Pruning is done explicitly with respect to the remaining gap.
+ */
+
+#include "tb2solver.hpp"
+#include "core/tb2wcsp.hpp"
+#include "core/tb2domain.hpp"
+
+static const size_t ComponentCacheLimit = 100000;
+
+/// \brief builds the constraint graph used to find the assigned neighbors of a subproblem
+/// \warning must be called at the root of the search, after preprocessing (no variable elimination during search)
+void Solver::initComponents()
+{
+    WCSP* problem = (WCSP*)wcsp;
+    unsigned int n = problem->numberOfVariables();
+    componentNeighbors.assign(n, vector<int>());
+    componentCache.clear();
+    componentNextNode = 0;
+    vector<Constraint*> ctrs;
+    for (unsigned int i = 0; i < problem->numberOfConstraints(); i++)
+        ctrs.push_back(problem->getCtr(i));
+    for (int i = 0; i < problem->getElimBinOrder(); i++)
+        ctrs.push_back(problem->getElimBinCtr(i));
+    for (int i = 0; i < problem->getElimTernOrder(); i++)
+        ctrs.push_back(problem->getElimTernCtr(i));
+    for (unsigned int c = 0; c < ctrs.size(); c++) {
+        Constraint* ctr = ctrs[c];
+        if (!ctr->connected() || ctr->isSep())
+            continue;
+        for (int i = 0; i < ctr->arity(); i++) {
+            for (int j = 0; j < ctr->arity(); j++) {
+                if (i != j)
+                    componentNeighbors[ctr->getVar(i)->wcspIndex].push_back(ctr->getVar(j)->wcspIndex);
+            }
+        }
+    }
+    for (unsigned int i = 0; i < n; i++) {
+        sort(componentNeighbors[i].begin(), componentNeighbors[i].end());
+        componentNeighbors[i].erase(unique(componentNeighbors[i].begin(), componentNeighbors[i].end()), componentNeighbors[i].end());
+    }
+}
+
+static int findComponent(vector<int>& parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/// \brief depth-first branch and bound restricted to the variables of one subproblem
+/// \param lbAtNode global lower bound when the subproblem was detected
+/// \param bound (in/out) maximum cost (excluded) of the subproblem, updated with the cost of the best assignment found
+/// \param best (out) best assignment found, in the same order as \a vars
+void Solver::solveComponent(const vector<int>& vars, Cost lbAtNode, Cost& bound, vector<Value>& best)
+{
+    if (ToulBar2::interrupted)
+        throw TimeOut();
+    if (wcsp->getLb() - lbAtNode >= bound)
+        THROWCONTRADICTION;
+    int varIndex = -1;
+    double bestScore = 0;
+    for (unsigned int i = 0; i < vars.size(); i++) {
+        if (wcsp->unassigned(vars[i])) {
+            double score = (double)wcsp->getDomainSize(vars[i]) / (double)(wcsp->getWeightedDegree(vars[i]) + 1);
+            if (varIndex < 0 || score < bestScore) {
+                varIndex = vars[i];
+                bestScore = score;
+            }
+        }
+    }
+    if (varIndex < 0) {
+        bound = wcsp->getLb() - lbAtNode;
+        best.resize(vars.size());
+        for (unsigned int i = 0; i < vars.size(); i++)
+            best[i] = wcsp->getValue(vars[i]);
+        return;
+    }
+    Value value = wcsp->getBestValue(varIndex);
+    if (wcsp->cannotbe(varIndex, value))
+        value = wcsp->getSupport(varIndex);
+    try {
+        Store::store();
+        assign(varIndex, value);
+        solveComponent(vars, lbAtNode, bound, best);
+    } catch (Contradiction) {
+        wcsp->whenContradiction();
+    }
+    Store::restore();
+    nbBacktracks++;
+    try {
+        Store::store();
+        remove(varIndex, value);
+        solveComponent(vars, lbAtNode, bound, best);
+    } catch (Contradiction) {
+        wcsp->whenContradiction();
+    }
+    Store::restore();
+}
+
+/// \brief splits the current problem into independent subproblems if possible and solves them separately
+/// \return false if the problem is not decomposable, true if it has been solved (a better solution has been found)
+/// \exception Contradiction if no better solution exists
+bool Solver::solveComponents()
+{
+    WCSP* problem = (WCSP*)wcsp;
+    unsigned int n = problem->numberOfVariables();
+    vector<int> parent(n);
+    for (unsigned int i = 0; i < n; i++)
+        parent[i] = i;
+    int nbUnassigned = 0;
+    for (BTList<Value>::iterator iter = unassignedVars->begin(); iter != unassignedVars->end(); ++iter) {
+        if (!wcsp->enumerated(*iter))
+            return false;
+        nbUnassigned++;
+        ConstraintList* ctrs = problem->getVar(*iter)->getConstrs();
+        for (ConstraintList::iterator it = ctrs->begin(); it != ctrs->end(); ++it) {
+            Constraint* ctr = (*it).constr;
+            for (int k = 0; k < ctr->arity(); k++) {
+                Variable* y = ctr->getVar(k);
+                if (y->unassigned()) {
+                    int rx = findComponent(parent, *iter);
+                    int ry = findComponent(parent, y->wcspIndex);
+                    if (rx != ry)
+                        parent[ry] = rx;
+                }
+            }
+        }
+    }
+    if (nbUnassigned < 2)
+        return false;
+    map<int, vector<int>> roots;
+    for (BTList<Value>::iterator iter = unassignedVars->begin(); iter != unassignedVars->end(); ++iter)
+        roots[findComponent(parent, *iter)].push_back(*iter);
+    if (roots.size() < 2)
+        return false;
+    vector<vector<int>> components;
+    for (map<int, vector<int>>::iterator iter = roots.begin(); iter != roots.end(); ++iter) {
+        components.push_back(iter->second);
+        sort(components.back().begin(), components.back().end());
+    }
+    stable_sort(components.begin(), components.end(), [](const vector<int>& a, const vector<int>& b) { return a.size() < b.size(); });
+    nbComponentSplits++;
+    if (ToulBar2::verbose >= 1)
+        cout << "[" << Store::getDepth() << "," << wcsp->getLb() << "," << wcsp->getUb() << "," << wcsp->getDomainSizeSum() << "] " << components.size() << " independent subproblems" << endl;
+
+    // the key of a subproblem is made of its domains followed by the values of its assigned neighbors
+    vector<vector<Value>> keys(components.size());
+    for (unsigned int c = 0; c < components.size(); c++) {
+        vector<Value>& key = keys[c];
+        vector<int> separator;
+        for (unsigned int i = 0; i < components[c].size(); i++) {
+            int x = components[c][i];
+            key.push_back(x);
+            key.push_back(wcsp->getDomainSize(x));
+            for (EnumeratedVariable::iterator iter = ((EnumeratedVariable*)problem->getVar(x))->begin(); iter != ((EnumeratedVariable*)problem->getVar(x))->end(); ++iter)
+                key.push_back(*iter);
+            for (unsigned int j = 0; j < componentNeighbors[x].size(); j++) {
+                if (wcsp->assigned(componentNeighbors[x][j]))
+                    separator.push_back(componentNeighbors[x][j]);
+            }
+        }
+        sort(separator.begin(), separator.end());
+        separator.erase(unique(separator.begin(), separator.end()), separator.end());
+        key.push_back(-1);
+        for (unsigned int j = 0; j < separator.size(); j++) {
+            key.push_back(separator[j]);
+            key.push_back(wcsp->getValue(separator[j]));
+        }
+    }
+
+    Cost lbAtNode = wcsp->getLb();
+    Cost ub = wcsp->getUb();
+    Cost gap = ub - lbAtNode;
+    vector<vector<Value>> bests(components.size());
+    vector<bool> cached(components.size(), false);
+    bool feasible = true;
+    Long hbfs_ = ToulBar2::hbfs;
+    ToulBar2::hbfs = 0; // no open nodes inside subproblems
+    wcsp->setUb(MAX_COST);
+    try {
+        for (unsigned int c = 0; c < components.size(); c++) {
+            map<vector<Value>, vector<Value>>::iterator hit = componentCache.find(keys[c]);
+            if (hit != componentCache.end()) {
+                bests[c] = hit->second;
+                cached[c] = true;
+                nbComponentHits++;
+                continue;
+            }
+            Cost bound = gap;
+            solveComponent(components[c], lbAtNode, bound, bests[c]);
+            if (bests[c].empty()) {
+                feasible = false; // no better solution
+                break;
+            }
+            gap -= bound;
+        }
+    } catch (...) {
+        ToulBar2::hbfs = hbfs_;
+        wcsp->setUb(ub);
+        throw;
+    }
+    ToulBar2::hbfs = hbfs_;
+    wcsp->setUb(ub);
+    if (!feasible)
+        THROWCONTRADICTION;
+
+    vector<int> variables;
+    vector<Value> values;
+    for (unsigned int c = 0; c < components.size(); c++) {
+        variables.insert(variables.end(), components[c].begin(), components[c].end());
+        values.insert(values.end(), bests[c].begin(), bests[c].end());
+    }
+    wcsp->assignLS(variables, values);
+    wcsp->propagate();
+    newSolution();
+
+    if (componentCache.size() + components.size() > ComponentCacheLimit)
+        componentCache.clear();
+    for (unsigned int c = 0; c < components.size(); c++) {
+        if (!cached[c])
+            componentCache[keys[c]] = bests[c];
+    }
+    return true;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
@@ -0,0 +1,279 @@
+/*
+ * **************** Nogood recording from restarts *******************
+ *
+ * At each restart, every left decision of the current branch whose subtree
+ * has been completely explored gives a reduced nld-nogood made of this
+ * decision and of all the previous positive decisions (the refuted decisions
+ * above it are not needed). A nogood forbids the conjunction of its literals,
+ * which cannot lead to a solution better than the current upper bound.
+ * Nogoods are propagated using two watched literals per nogood, such that
+ * nothing has to be undone on backtrack.
+ */
+
+#include "tb2solver.hpp"
+#include "core/tb2domain.hpp"
+
+static const double NogoodActivityDecay = 0.95;
+static const double NogoodActivityLimit = 1e100;
+
+Solver::NogoodStore::NogoodStore(WeightedCSP* wcsp_)
+    : wcsp(wcsp_)
+    , watches(wcsp_->numberOfVariables())
+    , queued(wcsp_->numberOfVariables(), false)
+    , activityInc(1.)
+    , nbRecorded(0)
+    , nbPropagations(0)
+    , nbConflicts(0)
+    , nbDeleted(0)
+{
+}
+
+Solver::NogoodStore::~NogoodStore()
+{
+    for (unsigned int i = 0; i < nogoods.size(); i++) {
+        delete nogoods[i];
+    }
+}
+
+bool Solver::NogoodStore::entailed(const Literal& lit) const
+{
+    switch (lit.op) {
+    case CP_ASSIGN:
+        return wcsp->assigned(lit.varIndex) && wcsp->getValue(lit.varIndex) == lit.value;
+    case CP_REMOVE:
+        return wcsp->cannotbe(lit.varIndex, lit.value);
+    case CP_INCREASE:
+        return wcsp->getInf(lit.varIndex) >= lit.value;
+    case CP_DECREASE:
+        return wcsp->getSup(lit.varIndex) <= lit.value;
+    default:
+        assert(false);
+        return false;
+    }
+}
+
+bool Solver::NogoodStore::falsified(const Literal& lit) const
+{
+    switch (lit.op) {
+    case CP_ASSIGN:
+        return wcsp->cannotbe(lit.varIndex, lit.value);
+    case CP_REMOVE:
+        return wcsp->assigned(lit.varIndex) && wcsp->getValue(lit.varIndex) == lit.value;
+    case CP_INCREASE:
+        return wcsp->getSup(lit.varIndex) < lit.value;
+    case CP_DECREASE:
+        return wcsp->getInf(lit.varIndex) > lit.value;
+    default:
+        assert(false);
+        return false;
+    }
+}
+
+void Solver::NogoodStore::enforceNegation(const Literal& lit)
+{
+    switch (lit.op) {
+    case CP_ASSIGN:
+        wcsp->remove(lit.varIndex, lit.value);
+        break;
+    case CP_REMOVE:
+        wcsp->assign(lit.varIndex, lit.value);
+        break;
+    case CP_INCREASE:
+        wcsp->decrease(lit.varIndex, lit.value - 1);
+        break;
+    case CP_DECREASE:
+        wcsp->increase(lit.varIndex, lit.value + 1);
+        break;
+    default:
+        assert(false);
+    }
+}
+
+void Solver::NogoodStore::bump(Nogood* ng)
+{
+    ng->activity += activityInc;
+    if (ng->activity > NogoodActivityLimit) {
+        for (unsigned int i = 0; i < nogoods.size(); i++) {
+            nogoods[i]->activity /= NogoodActivityLimit;
+        }
+        activityInc /= NogoodActivityLimit;
+    }
+}
+
+/// \brief marks the left decision taken just after \a mark as refuted and forgets the decisions of its subtree
+/// \warning must be called after the subtree has been explored and the left decision undone (Store::restore)
+void Solver::NogoodStore::refute(size_t mark)
+{
+    if (mark >= branch.size())
+        return; // the left decision was not recorded
+    Long node = branch[mark].node;
+    size_t last = mark;
+    while (last < branch.size() && branch[last].node == node) {
+        branch[last].refuted = true;
+        last++;
+    }
+    branch.resize(last);
+}
+
+/// \brief records the nogoods of the current branch and forgets it, to be called after a restart at the root node
+void Solver::NogoodStore::record()
+{
+    vector<Literal> positives;
+    size_t i = 0;
+    while (i < branch.size()) {
+        if (!branch[i].refuted) {
+            positives.push_back(branch[i].lit);
+            i++;
+        } else {
+            vector<Literal> lits(positives);
+            Long node = branch[i].node;
+            while (i < branch.size() && branch[i].refuted && branch[i].node == node) {
+                lits.push_back(branch[i].lit);
+                i++;
+            }
+            add(lits);
+        }
+    }
+    branch.clear();
+
+    activityInc /= NogoodActivityDecay;
+    if (nogoods.size() > (size_t)ToulBar2::maxNogoods)
+        reduce();
+}
+
+/// \brief adds a new nogood simplified with respect to the current (root) domains
+void Solver::NogoodStore::add(vector<Literal>& lits)
+{
+    Nogood* ng = new Nogood;
+    ng->activity = activityInc;
+    for (unsigned int i = 0; i < lits.size(); i++) {
+        if (falsified(lits[i])) {
+            delete ng; // never violated in the future
+            return;
+        }
+        if (!entailed(lits[i]))
+            ng->lits.push_back(lits[i]);
+    }
+    if (ng->lits.empty())
+        ng->lits.push_back(lits.back()); // no better solution, detected by the next propagation
+    nogoods.push_back(ng);
+    nbRecorded++;
+    for (unsigned int w = 0; w < min((size_t)2, ng->lits.size()); w++) {
+        int varIndex = ng->lits[w].varIndex;
+        watches[varIndex].push_back(ng);
+        if (!queued[varIndex]) {
+            queued[varIndex] = true;
+            pending.push_back(varIndex);
+        }
+    }
+}
+
+/// \brief keeps only the most active half of the nogoods
+void Solver::NogoodStore::reduce()
+{
+    stable_sort(nogoods.begin(), nogoods.end(), [](const Nogood* a, const Nogood* b) { return a->activity > b->activity; });
+    size_t keep = ToulBar2::maxNogoods / 2;
+    for (size_t i = keep; i < nogoods.size(); i++) {
+        delete nogoods[i];
+        nbDeleted++;
+    }
+    nogoods.resize(keep);
+    for (unsigned int i = 0; i < watches.size(); i++) {
+        watches[i].clear();
+    }
+    for (unsigned int i = 0; i < nogoods.size(); i++) {
+        for (unsigned int w = 0; w < min((size_t)2, nogoods[i]->lits.size()); w++) {
+            watches[nogoods[i]->lits[w].varIndex].push_back(nogoods[i]);
+        }
+    }
+    if (ToulBar2::verbose >= 1)
+        cout << "c " << nbDeleted << " nogoods deleted, " << nogoods.size() << " kept." << endl;
+}
+
+/// \brief visits the nogoods watching a literal on a modified variable and prunes the last literal of those having all their other literals entailed
+/// \return true if a domain has been reduced (then WCSP propagation must be called again)
+/// \exception Contradiction if all the literals of a nogood are entailed
+bool Solver::NogoodStore::propagate()
+{
+    vector<Literal> units;
+    Nogood* conflict = NULL;
+    while (!conflict && !pending.empty()) {
+        int varIndex = pending.back();
+        pending.pop_back();
+        queued[varIndex] = false;
+        vector<Nogood*>& ws = watches[varIndex];
+        size_t j = 0;
+        for (size_t i = 0; i < ws.size(); i++) {
+            Nogood* ng = ws[i];
+            vector<Literal>& lits = ng->lits;
+            if (lits.size() == 1) {
+                ws[j++] = ng;
+                if (entailed(lits[0]))
+                    conflict = ng;
+                else if (!falsified(lits[0])) {
+                    bump(ng);
+                    units.push_back(lits[0]);
+                }
+                continue;
+            }
+            if (lits[0].varIndex == varIndex && entailed(lits[0]))
+                swap(lits[0], lits[1]);
+            if (lits[1].varIndex != varIndex || !entailed(lits[1])) {
+                ws[j++] = ng;
+                continue;
+            }
+            size_t k = 2;
+            while (k < lits.size() && entailed(lits[k]))
+                k++;
+            if (k < lits.size()) {
+                swap(lits[1], lits[k]);
+                if (lits[1].varIndex == varIndex)
+                    ws[j++] = ng;
+                else
+                    watches[lits[1].varIndex].push_back(ng);
+                continue;
+            }
+            ws[j++] = ng;
+            if (entailed(lits[0])) {
+                conflict = ng;
+            } else if (!falsified(lits[0])) {
+                bump(ng);
+                units.push_back(lits[0]);
+            }
+        }
+        ws.resize(j);
+    }
+    if (conflict) {
+        bump(conflict);
+        nbConflicts++;
+        throw Contradiction();
+    }
+    for (unsigned int i = 0; i < units.size(); i++) {
+        nbPropagations++;
+        enforceNegation(units[i]);
+    }
+    return !units.empty();
+}
+
+/// \brief propagates nogoods and soft local consistency until a common fixpoint is reached
+void Solver::propagateNogoods()
+{
+    assert(nogoods);
+    while (nogoods->propagate())
+        wcsp->propagate();
+}
+
+/// \brief domain event handler used to wake up the nogoods watching a literal on the modified variable
+void nogoodEvent(int wcspId, int varIndex, Value value, void* _solver_)
+{
+    Solver* solver = (Solver*)_solver_;
+    if (solver->nogoods)
+        solver->nogoods->notify(varIndex);
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
@@ -0,0 +1,193 @@
+/*
+ * **************** Parallel Limited Discrepancy Search *******************
+ *
+ * Distinct discrepancy levels are explored concurrently by forked processes,
+ * each one working on its own copy of the problem. They share the best
+ * solution found so far through an anonymous shared memory segment, such
+ * that every process prunes with the best known primal bound.
+ */
+
+#include "tb2solver.hpp"
+#include "core/tb2domain.hpp"
+
+#ifdef LINUX
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+/// \brief incumbent shared by parallel LDS processes, followed in memory by one value per variable
+struct LDSIncumbent {
+    volatile int lock;
+    Cost ub;
+    Long nbNodes; // search effort done by finished processes
+    Long nbBacktracks;
+
+    Value* solution() { return (Value*)(this + 1); }
+    void acquire()
+    {
+        while (__sync_lock_test_and_set(&lock, 1))
+            sched_yield();
+    }
+    void release() { __sync_lock_release(&lock); }
+};
+
+/// \brief exchanges primal bounds with the other LDS processes
+/// \param publish if true, offers the current (complete) assignment as a new incumbent, else only tightens the local upper bound
+void Solver::syncLDSIncumbent(bool publish)
+{
+    assert(ldsShared);
+    LDSIncumbent* shared = (LDSIncumbent*)ldsShared;
+    shared->acquire();
+    if (publish) {
+        if (wcsp->getUb() < shared->ub) {
+            shared->ub = wcsp->getUb();
+            Value* solution = shared->solution();
+            for (unsigned int i = 0; i < wcsp->numberOfVariables(); i++) {
+                solution[i] = wcsp->getValue(i);
+            }
+        }
+    } else if (shared->ub < wcsp->getUb()) {
+        wcsp->updateUb(shared->ub);
+    }
+    shared->release();
+}
+
+/// \brief runs all the remaining discrepancy levels up to ToulBar2::lds using ToulBar2::ldsJobs processes
+/// \return the last discrepancy level explored
+/// \note sets ToulBar2::limited to false if one level has been explored completely (the best solution is then optimal)
+int Solver::parallelLDS(int discrepancy)
+{
+    vector<int> levels;
+    for (int d = discrepancy; d <= abs(ToulBar2::lds); d = ((d > 0) ? 2 * d : 1)) {
+        levels.push_back(d);
+    }
+    assert(levels.size() > 0);
+    if (ToulBar2::verbose >= 0) {
+        cout << "--- [" << Store::getDepth() << "] LDS";
+        for (unsigned int i = 0; i < levels.size(); i++)
+            cout << ((i > 0) ? "," : " ") << levels[i];
+        cout << " with " << min((size_t)ToulBar2::ldsJobs, levels.size()) << " processes --- (" << nbNodes << " nodes)" << endl;
+    }
+
+#ifdef LINUX
+    size_t size = sizeof(LDSIncumbent) + wcsp->numberOfVariables() * sizeof(Value);
+    void* segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (segment == MAP_FAILED) {
+        cerr << "Error: cannot allocate shared memory for parallel LDS." << endl;
+        exit(EXIT_FAILURE);
+    }
+    LDSIncumbent* shared = (LDSIncumbent*)segment;
+    shared->lock = 0;
+    shared->ub = wcsp->getUb();
+    shared->nbNodes = 0;
+    shared->nbBacktracks = 0;
+
+    // interval timers are not inherited by child processes
+    struct itimerval remaining;
+    getitimer(ITIMER_VIRTUAL, &remaining);
+
+    cout.flush();
+    fflush(stdout);
+    vector<pid_t> running;
+    bool complete = false;
+    bool expired = false;
+    unsigned int next = 0;
+    while (!complete && !expired && (next < levels.size() || running.size() > 0)) {
+        while (!complete && !expired && next < levels.size() && running.size() < (size_t)ToulBar2::ldsJobs) {
+            int level = levels[next++];
+            pid_t pid = fork();
+            if (pid < 0) {
+                cerr << "Error: cannot fork parallel LDS process." << endl;
+                exit(EXIT_FAILURE);
+            }
+            if (pid == 0) {
+                prctl(PR_SET_PDEATHSIG, SIGKILL);
+                signal(SIGINT, SIG_DFL);
+                signal(SIGTERM, SIG_DFL);
+                signal(SIGVTALRM, SIG_DFL); // dies silently when the time limit is reached
+                if (remaining.it_value.tv_sec > 0 || remaining.it_value.tv_usec > 0)
+                    setitimer(ITIMER_VIRTUAL, &remaining, NULL);
+                // only the parent process reports solutions
+                ToulBar2::verbose = -1;
+                ToulBar2::showSolutions = 0;
+                ToulBar2::writeSolution = NULL;
+                ToulBar2::xmlflag = false;
+                ToulBar2::maxsateval = false;
+                ToulBar2::uai = 0;
+                ToulBar2::uaieval = false;
+                ToulBar2::newsolution = NULL;
+                telemetry = NULL;
+                ldsShared = shared;
+                ToulBar2::limited = false;
+                int status = 0;
+                try {
+                    try {
+                        Store::store();
+                        initialDepth = Store::getDepth();
+                        recursiveSolveLDS(level);
+                    } catch (Contradiction) {
+                        wcsp->whenContradiction();
+                    }
+                    status = (ToulBar2::limited) ? 1 : 0;
+                } catch (...) {
+                    status = 2;
+                }
+                shared->acquire();
+                shared->nbNodes += nbNodes;
+                shared->nbBacktracks += nbBacktracks;
+                shared->release();
+                _exit(status);
+            }
+            running.push_back(pid);
+        }
+        int status = 0;
+        pid_t pid = wait(&status);
+        if (pid < 0)
+            break;
+        running.erase(std::remove(running.begin(), running.end(), pid), running.end());
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+            complete = true;
+        if (WIFSIGNALED(status) && WTERMSIG(status) == SIGVTALRM)
+            expired = true; // all the children share the same time limit
+    }
+    for (unsigned int i = 0; i < running.size(); i++) {
+        kill(running[i], SIGKILL);
+        waitpid(running[i], NULL, 0);
+    }
+
+    nbNodes += shared->nbNodes;
+    nbBacktracks += shared->nbBacktracks;
+    if (shared->ub < wcsp->getUb())
+        replaySolution(shared->solution()); // best solution found by the children
+    munmap(segment, size);
+    ToulBar2::limited = !complete;
+    if (expired)
+        timeOut(SIGVTALRM);
+#else
+    for (unsigned int i = 0; i < levels.size(); i++) {
+        ToulBar2::limited = false;
+        try {
+            Store::store();
+            initialDepth = Store::getDepth();
+            recursiveSolveLDS(levels[i]);
+        } catch (Contradiction) {
+            wcsp->whenContradiction();
+        }
+        Store::restore();
+        if (!ToulBar2::limited)
+            break;
+    }
+#endif
+    return levels.back();
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
@@ -0,0 +1,152 @@
+/*
+ * **************** Parallel Singleton Consistency *******************
+ *
+ * At each pass, the (variable, value) probes of singleton consistency are
+ * shared among forked processes, each one working on its own copy of the
+ * problem propagated at the root. A process also removes its own dead ends
+ * before its next probes, as the sequential version does. The dead ends are
+ * reported through an anonymous shared memory segment and removed by the
+ * parent process, which repeats the passes until no value is removed.
+ */
+
+#include "tb2solver.hpp"
+#include "core/tb2domain.hpp"
+
+#ifdef LINUX
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+int cmpValueCost(const void* p1, const void* p2);
+
+/// \brief results of the probes of one pass, followed in memory by one flag per probe
+struct SACProbes {
+    Long nbNodes; // probes done by all the processes
+    volatile bool inconsistent; // a process has wiped out a domain by removing its own dead ends
+
+    char* deadends() { return (char*)(this + 1); }
+};
+
+/// \brief singleton consistency using ToulBar2::sacJobs processes (see singletonConsistency)
+/// \note removes the same values as the sequential version at its fixpoint, but possibly in a different order, thus with possibly different unary costs
+void Solver::parallelSingletonConsistency()
+{
+#ifdef LINUX
+    bool done = false;
+    while (!done) {
+        done = true;
+        // probes by variable and increasing unary cost, interleaved among processes for a balanced load
+        vector<pair<int, Value>> probes;
+        for (unsigned int varIndex = 0; varIndex < ((ToulBar2::nbDecisionVars > 0) ? ToulBar2::nbDecisionVars : wcsp->numberOfVariables()); varIndex++) {
+            int size = wcsp->getDomainSize(varIndex);
+            vector<ValueCost> sorted(size);
+            wcsp->getEnumDomainAndCost(varIndex, &sorted[0]);
+            qsort(&sorted[0], size, sizeof(ValueCost), cmpValueCost);
+            for (int a = 0; a < size; a++)
+                probes.push_back(make_pair(varIndex, sorted[a].value));
+        }
+        int jobs = min((size_t)ToulBar2::sacJobs, probes.size());
+
+        size_t size = sizeof(SACProbes) + probes.size();
+        void* segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (segment == MAP_FAILED) {
+            cerr << "Error: cannot allocate shared memory for parallel singleton consistency." << endl;
+            exit(EXIT_FAILURE);
+        }
+        SACProbes* shared = (SACProbes*)segment; // zero-filled by mmap
+
+        // interval timers are not inherited by child processes
+        struct itimerval remaining;
+        getitimer(ITIMER_VIRTUAL, &remaining);
+
+        cout.flush();
+        fflush(stdout);
+        vector<pid_t> running;
+        for (int job = 0; job < jobs; job++) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                cerr << "Error: cannot fork parallel singleton consistency process." << endl;
+                exit(EXIT_FAILURE);
+            }
+            if (pid == 0) {
+                prctl(PR_SET_PDEATHSIG, SIGKILL);
+                signal(SIGINT, SIG_DFL);
+                signal(SIGTERM, SIG_DFL);
+                signal(SIGVTALRM, SIG_DFL); // dies silently when the time limit is reached
+                if (remaining.it_value.tv_sec > 0 || remaining.it_value.tv_usec > 0)
+                    setitimer(ITIMER_VIRTUAL, &remaining, NULL);
+                ToulBar2::verbose = -1;
+                telemetry = NULL;
+                Long nodes = nbNodes;
+                try {
+                    for (size_t i = job; i < probes.size(); i += jobs) {
+                        int varIndex = probes[i].first;
+                        Value value = probes[i].second;
+                        if (wcsp->cannotbe(varIndex, value))
+                            continue;
+                        bool deadend = false;
+                        try {
+                            Store::store();
+                            assign(varIndex, value);
+                        } catch (Contradiction) {
+                            wcsp->whenContradiction();
+                            deadend = true;
+                        }
+                        Store::restore();
+                        if (deadend) {
+                            shared->deadends()[i] = 1;
+                            remove(varIndex, value);
+                        }
+                    }
+                } catch (Contradiction) {
+                    shared->inconsistent = true;
+                }
+                __sync_fetch_and_add(&shared->nbNodes, nbNodes - nodes);
+                _exit(0);
+            }
+            running.push_back(pid);
+        }
+        bool expired = false;
+        for (unsigned int i = 0; i < running.size(); i++) {
+            int status = 0;
+            waitpid(running[i], &status, 0);
+            if (WIFSIGNALED(status) && WTERMSIG(status) == SIGVTALRM)
+                expired = true;
+        }
+
+        nbNodes += shared->nbNodes;
+        bool inconsistent = shared->inconsistent;
+        vector<char> deadends(shared->deadends(), shared->deadends() + probes.size());
+        munmap(segment, size);
+        if (expired)
+            timeOut(SIGVTALRM);
+        if (inconsistent)
+            THROWCONTRADICTION;
+
+        for (size_t i = 0; i < probes.size(); i++) {
+            if (deadends[i] && wcsp->canbe(probes[i].first, probes[i].second)) {
+                remove(probes[i].first, probes[i].second);
+                done = false;
+                if (ToulBar2::verbose >= 0) {
+                    cout << ".";
+                    flush(cout);
+                }
+            }
+        }
+    }
+    if (ToulBar2::verbose >= 0)
+        cout << "Done Singleton Consistency" << endl;
+#else
+    singletonConsistency();
+#endif
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
@@ -25,7 +25,7 @@
 #ifdef OPENMPI
 #include "cpd/tb2negjobs.hpp"
 #include "vns/tb2cpdgvns.hpp"
-#include "vns/tb2rpdgvns.hpp"
+#include "vns/tb2rpdgvns.hpp"
 #endif
 
 #include <unistd.h>
@@ -93,8 +93,11 @@ double stdDev(std::vector<T> samples) {
 Solver::Solver(Cost initUpperBound)
         : nbNodes(0), nbBacktracks(0), nbBacktracksLimit(LONGLONG_MAX), wcsp(NULL), allVars(NULL), unassignedVars(NULL),
           lastConflictVar(-1), nbSol(0.), nbSGoods(0), nbSGoodsUse(0), tailleSep(0), cp(NULL), open(NULL),
-          hbfsLimit(LONGLONG_MAX), nbHybrid(0), nbHybridContinue(0), nbHybridNew(0), nbRecomputationNodes(0),
-          initialLowerBound(MIN_COST), globalLowerBound(MIN_COST), globalUpperBound(MAX_COST), initialDepth(0) {
+          hbfsLimit(LONGLONG_MAX), nbHybrid(0), nbHybridContinue(0), nbHybridNew(0), nbRecomputationNodes(0), nogoods(NULL),
+          componentNextNode(0), nbComponentSplits(0), nbComponentHits(0),
+          telemetry(NULL), telemetryStartTime(0), telemetryLastTime(0), telemetryLastNodes(0),
+          initialLowerBound(MIN_COST), globalLowerBound(MIN_COST), globalUpperBound(MAX_COST), initialDepth(0),
+          ldsShared(NULL), checkpointLastTime(0) {
     searchSize = new StoreCost(MIN_COST);
     wcsp = WeightedCSP::makeWeightedCSP(initUpperBound, (void *) this);
 }
@@ -102,12 +105,15 @@ Solver::Solver(Cost initUpperBound)
 Solver::~Solver() {
     delete cp;
     delete open;
+    delete nogoods;
     delete unassignedVars;
     delete[] allVars;
     delete wcsp;
     delete ((StoreCost *) searchSize);
 
     dataFile.close();
+    if (telemetry)
+        fclose(telemetry);
 }
 
 void Solver::initVarHeuristic() {
@@ -138,10 +144,11 @@ void Solver::initVarHeuristic() {
 
     // Now get all the pairwise costs
     std::vector<Double> allBinaryCosts;
-    std::vector<Variable*> variables = wcsp->getVars();
+    const std::vector<Variable*>& variables = wcsp->getVars();
     for (unsigned int i = 0; i < variables.size(); i++) {
         Variable* currVar = variables.at(i);
-        Value* domain1 = new Value[wcsp->getDomainSize(i)];
+        ScratchScope scope(scratch);
+        Value* domain1 = scratch.alloc<Value>(wcsp->getDomainSize(i));
         wcsp->getEnumDomain(i, domain1);
 
         for (unsigned int j = i + 1; j < variables.size(); j++) {
@@ -149,21 +156,22 @@ void Solver::initVarHeuristic() {
             if (i != j) {
                 BinaryConstraint *bc = currVar->getConstr(variables.at(j));
                 if (bc != nullptr) {
-                    Value* domain2 = new Value[wcsp->getDomainSize(j)];
+                    ScratchScope scope(scratch);
+                    Value* domain2 = scratch.alloc<Value>(wcsp->getDomainSize(j));
                     wcsp->getEnumDomain(j, domain2);
                     for (unsigned int k = 0; k < wcsp->getDomainSize(i); k++) {
                         for (unsigned int l = 0; l < wcsp->getDomainSize(j); l++) {
                             allBinaryCosts.push_back(bc->getCost(domain1[k], domain2[l]));
                         }
                     }
-                    delete domain2;
                 }
             }
         }
-        delete domain1;
     }
 
     // get statistics on costs vector
+    if (allBinaryCosts.empty()) // all the binary cost functions may have been removed by variable elimination in preprocessing
+        allBinaryCosts.push_back(MIN_COST);
     std::sort(allBinaryCosts.begin(), allBinaryCosts.end());
     meanAllBinaryCost = mean(allBinaryCosts);
     medianAllBinaryCost = median(allBinaryCosts);
@@ -436,6 +444,8 @@ void setvalue(int wcspId, int varIndex, Value value, void *_solver_) {
     if (!solver->allVars[i].removed) {
         solver->unassignedVars->erase(&solver->allVars[i], true);
     }
+    if (solver->nogoods)
+        solver->nogoods->notify(varIndex);
 }
 
 /*
@@ -455,7 +465,8 @@ int Solver::getNextUnassignedVar() {
 int Solver::getNextScpCandidate() {
     if (lastConflictVar != -1 && wcsp->unassigned(lastConflictVar)) {
         unsigned int domsize = wcsp->getDomainSize(lastConflictVar);
-        Value values[domsize];
+        ScratchScope scope(scratch);
+        Value* values = scratch.alloc<Value>(domsize);
         wcsp->getEnumDomain(lastConflictVar, values);
         if (ToulBar2::scpbranch->multipleAA(lastConflictVar, values, domsize))
             return lastConflictVar;
@@ -467,11 +478,12 @@ int Solver::getNextScpCandidate() {
     for (BTList<Value>::iterator iter = unassignedVars->begin(); iter != unassignedVars->end(); ++iter) {
         Cost unarymediancost = MIN_COST;
         int domsize = wcsp->getDomainSize(*iter);
-        Value values[domsize];
+        ScratchScope scope(scratch);
+        Value* values = scratch.alloc<Value>(domsize);
         wcsp->getEnumDomain(*iter, values);
         if (ToulBar2::scpbranch->multipleAA(*iter, values, domsize)) {
             if (ToulBar2::weightedTightness) {
-                ValueCost array[domsize];
+                ValueCost* array = scratch.alloc<ValueCost>(domsize);
                 wcsp->getEnumDomainAndCost(*iter, array);
                 unarymediancost = stochastic_selection<ValueCost>(array, 0, domsize - 1, domsize / 2).cost;
             }
@@ -524,7 +536,8 @@ int Solver::getVarMinDomainDivMaxDegreeRandomized() {
     int varIndex = -1;
     Cost worstUnaryCost = MIN_COST;
     double best = MAX_VAL - MIN_VAL;
-    int ties[unassignedVars->getSize()];
+    ScratchScope scope(scratch);
+    int* ties = scratch.alloc<int>(unassignedVars->getSize());
     int nbties = 0;
 
     for (BTList<Value>::iterator iter = unassignedVars->begin(); iter != unassignedVars->end(); ++iter) {
@@ -576,7 +589,8 @@ int Solver::getVarMinDomainDivMaxDegreeLastConflictRandomized() {
     int varIndex = -1;
     Cost worstUnaryCost = MIN_COST;
     double best = MAX_VAL - MIN_VAL;
-    int ties[unassignedVars->getSize()];
+    ScratchScope scope(scratch);
+    int* ties = scratch.alloc<int>(unassignedVars->getSize());
     int nbties = 0;
 
     for (BTList<Value>::iterator iter = unassignedVars->begin(); iter != unassignedVars->end(); ++iter) {
@@ -610,7 +624,8 @@ int Solver::getVarMinDomainDivMaxWeightedDegree() {
         Cost unarymediancost = MIN_COST;
         int domsize = wcsp->getDomainSize(*iter);
         if (ToulBar2::weightedTightness) {
-            ValueCost array[domsize];
+            ScratchScope scope(scratch);
+            ValueCost* array = scratch.alloc<ValueCost>(domsize);
             wcsp->getEnumDomainAndCost(*iter, array);
             unarymediancost = stochastic_selection<ValueCost>(array, 0, domsize - 1, domsize / 2).cost;
         }
@@ -629,14 +644,16 @@ int Solver::getVarMinDomainDivMaxWeightedDegreeRandomized() {
     int varIndex = -1;
     Cost worstUnaryCost = MIN_COST;
     double best = MAX_VAL - MIN_VAL;
-    int ties[unassignedVars->getSize()];
+    ScratchScope scope(scratch);
+    int* ties = scratch.alloc<int>(unassignedVars->getSize());
     int nbties = 0;
 
     for (BTList<Value>::iterator iter = unassignedVars->begin(); iter != unassignedVars->end(); ++iter) {
         Cost unarymediancost = MIN_COST;
         int domsize = wcsp->getDomainSize(*iter);
         if (ToulBar2::weightedTightness) {
-            ValueCost array[domsize];
+            ScratchScope scope(scratch);
+            ValueCost* array = scratch.alloc<ValueCost>(domsize);
             wcsp->getEnumDomainAndCost(*iter, array);
             unarymediancost = stochastic_selection<ValueCost>(array, 0, domsize - 1, domsize / 2).cost;
         }
@@ -669,7 +686,8 @@ int Solver::getVarMinDomainDivMaxWeightedDegreeLastConflict() {
         Cost unarymediancost = MIN_COST;
         int domsize = wcsp->getDomainSize(*iter);
         if (ToulBar2::weightedTightness) {
-            ValueCost array[domsize];
+            ScratchScope scope(scratch);
+            ValueCost* array = scratch.alloc<ValueCost>(domsize);
             wcsp->getEnumDomainAndCost(*iter, array);
             unarymediancost = stochastic_selection<ValueCost>(array, 0, domsize - 1, domsize / 2).cost;
         }
@@ -693,14 +711,16 @@ int Solver::getVarMinDomainDivMaxWeightedDegreeLastConflictRandomized() {
     int varIndex = -1;
     Cost worstUnaryCost = MIN_COST;
     double best = MAX_VAL - MIN_VAL;
-    int ties[unassignedVars->getSize()];
+    ScratchScope scope(scratch);
+    int* ties = scratch.alloc<int>(unassignedVars->getSize());
     int nbties = 0;
 
     for (BTList<Value>::iterator iter = unassignedVars->begin(); iter != unassignedVars->end(); ++iter) {
         Cost unarymediancost = MIN_COST;
         int domsize = wcsp->getDomainSize(*iter);
         if (ToulBar2::weightedTightness) {
-            ValueCost array[domsize];
+            ScratchScope scope(scratch);
+            ValueCost* array = scratch.alloc<ValueCost>(domsize);
             wcsp->getEnumDomainAndCost(*iter, array);
             unarymediancost = stochastic_selection<ValueCost>(array, 0, domsize - 1, domsize / 2).cost;
         }
@@ -770,8 +790,12 @@ void Solver::increase(int varIndex, Value value, bool reverse) {
         cout << "] Try " << wcsp->getName(varIndex) << " >= " << value << " (s:" << wcsp->getSupport(varIndex) << ")"
              << endl;
     }
+    if (nogoods)
+        nogoods->decide(CP_INCREASE, varIndex, value, nbNodes);
     wcsp->increase(varIndex, value);
     wcsp->propagate();
+    if (nogoods)
+        propagateNogoods();
     if (ToulBar2::hbfs)
         addChoicePoint(CP_INCREASE, varIndex, value, reverse);
 }
@@ -795,8 +819,12 @@ void Solver::decrease(int varIndex, Value value, bool reverse) {
         cout << "] Try " << wcsp->getName(varIndex) << " <= " << value << " (s:" << wcsp->getSupport(varIndex) << ")"
              << endl;
     }
+    if (nogoods)
+        nogoods->decide(CP_DECREASE, varIndex, value, nbNodes);
     wcsp->decrease(varIndex, value);
     wcsp->propagate();
+    if (nogoods)
+        propagateNogoods();
     if (ToulBar2::hbfs)
         addChoicePoint(CP_DECREASE, varIndex, value, reverse);
 }
@@ -849,8 +877,12 @@ void Solver::assign(int varIndex, Value value, bool reverse) {
             cout << ",C" << wcsp->getTreeDec()->getCurrentCluster()->getId();
         cout << "] Try " << wcsp->getName(varIndex) << " == " << value << endl;
     }
+    if (nogoods)
+        nogoods->decide(CP_ASSIGN, varIndex, value, nbNodes);
     wcsp->assign(varIndex, value);
     wcsp->propagate();
+    if (nogoods)
+        propagateNogoods();
     if (ToulBar2::hbfs)
         addChoicePoint(CP_ASSIGN, varIndex, value, reverse);
 }
@@ -874,8 +906,12 @@ void Solver::remove(int varIndex, Value value, bool reverse) {
         cout << "] Try " << wcsp->getName(varIndex) << " != " << value << endl;
     }
 
+    if (nogoods)
+        nogoods->decide(CP_REMOVE, varIndex, value, nbNodes);
     wcsp->remove(varIndex, value);
     wcsp->propagate();
+    if (nogoods)
+        propagateNogoods();
     if (ToulBar2::hbfs)
         addChoicePoint(CP_REMOVE, varIndex, value, reverse);
 }
@@ -901,9 +937,15 @@ void Solver::remove(int varIndex, ValueCost *array, int first, int last, bool re
             cout << " " << array[i].value;
         cout << endl;
     }
+    if (nogoods) {
+        for (int i = first; i <= last; i++)
+            nogoods->decide(CP_REMOVE, varIndex, array[i].value, nbNodes);
+    }
     for (int i = first; i <= last; i++)
         wcsp->remove(varIndex, array[i].value);
     wcsp->propagate();
+    if (nogoods)
+        propagateNogoods();
     if (ToulBar2::hbfs)
         addChoicePoint(CP_REMOVE_RANGE, varIndex, array[first].value, reverse); // Warning! only first value memorized!
 }
@@ -1038,6 +1080,65 @@ void Solver::showGap(Cost newLb, Cost newUb) {
     }
 }
 
+void Solver::openTelemetry() {
+    if (ToulBar2::telemetryFile.empty() || telemetry)
+        return;
+    telemetry = openStream(ToulBar2::telemetryFile.c_str());
+    if (!telemetry) {
+        cerr << "Could not open telemetry stream: " << ToulBar2::telemetryFile << endl;
+        exit(EXIT_FAILURE);
+    }
+    telemetryStartTime = realTime();
+    telemetryLastTime = telemetryStartTime;
+    telemetryLastNodes = nbNodes;
+    writeTelemetry("start", true);
+}
+
+/// \brief emits one JSON record per line, at most every ToulBar2::telemetryPeriod seconds unless \a force is true
+void Solver::writeTelemetry(const char *event, bool force) {
+    assert(telemetry);
+    double now = realTime();
+    if (!force && now - telemetryLastTime < ToulBar2::telemetryPeriod)
+        return;
+    double rate = (now > telemetryLastTime) ? (nbNodes - telemetryLastNodes) / (now - telemetryLastTime) : 0.;
+    Cost lb = globalLowerBound;
+    Cost ub = MIN(globalUpperBound, wcsp->getUb());
+    Double Dglb = (ToulBar2::costMultiplier >= 0 ? wcsp->Cost2ADCost(lb) : wcsp->Cost2ADCost(ub));
+    Double Dgub = (ToulBar2::costMultiplier >= 0 ? wcsp->Cost2ADCost(ub) : wcsp->Cost2ADCost(lb));
+    ostringstream os;
+    os << "{\"event\":\"" << event << "\""
+       << std::fixed << std::setprecision(3)
+       << ",\"timestamp\":" << now
+       << ",\"elapsed\":" << now - telemetryStartTime
+       << ",\"cpu\":" << cpuTime() - ToulBar2::startCpuTime
+       << ",\"nodes\":" << nbNodes
+       << ",\"backtracks\":" << nbBacktracks
+       << ",\"nodes_per_sec\":" << std::setprecision(1) << rate
+       << ",\"lb\":" << std::setprecision(ToulBar2::decimalPoint) << Dglb
+       << ",\"ub\":" << Dgub
+       << ",\"open\":" << (open ? open->size() : 0)
+       << ",\"cpstore\":" << (cp ? cp->size() : 0)
+       << ",\"depth\":" << Store::getDepth()
+       << ",\"store\":{\"value\":" << StoreValue::mystore.size()
+       << ",\"cost\":" << StoreCost::mystore.size()
+       << ",\"costblock\":" << Store::storeCostBlock.size()
+       << ",\"biginteger\":" << StoreBigInteger::mystore.size()
+       << ",\"domain\":" << Store::storeDomain.size()
+       << ",\"constraint\":" << Store::storeConstraint.size()
+       << ",\"variable\":" << Store::storeVariable.size()
+       << ",\"separator\":" << Store::storeSeparator.size() << "}"
+       << ",\"rss\":" << residentMemory() << "}" << endl;
+    if (fputs(os.str().c_str(), telemetry) == EOF || fflush(telemetry) == EOF) {
+        if (ToulBar2::verbose >= 0)
+            cout << "Warning! Telemetry stream closed, no more records will be sent." << endl;
+        fclose(telemetry);
+        telemetry = NULL;
+        return;
+    }
+    telemetryLastTime = now;
+    telemetryLastNodes = nbNodes;
+}
+
 void Solver::binaryChoicePoint(int varIndex, Value value, Cost lb) {
     assert(wcsp->unassigned(varIndex));
     assert(wcsp->canbe(varIndex, value));
@@ -1047,7 +1148,8 @@ void Solver::binaryChoicePoint(int varIndex, Value value, Cost lb) {
     bool dichotomic = (ToulBar2::dichotomicBranching && ToulBar2::dichotomicBranchingSize < domsize);
     Value middle = domsize / 2;
     bool increasing = true;
-    ValueCost sorted[domsize];
+    ScratchScope scope(scratch);
+    ValueCost* sorted = scratch.alloc<ValueCost>(domsize);
     //	bool reverse = true; // (ToulBar2::restart>0);
     if (dichotomic) {
         if (ToulBar2::dichotomicBranching == 1) {
@@ -1065,6 +1167,7 @@ void Solver::binaryChoicePoint(int varIndex, Value value, Cost lb) {
         //    	value = wcsp->getMaxUnaryCostValue(varIndex);
         //		assert(wcsp->canbe(varIndex,value));
     }
+    size_t branchMark = (nogoods) ? nogoods->mark() : 0;
     try {
         Store::store();
         lastConflictVar = varIndex;
@@ -1090,11 +1193,14 @@ void Solver::binaryChoicePoint(int varIndex, Value value, Cost lb) {
         wcsp->whenContradiction();
     }
     Store::restore();
+    if (nogoods)
+        nogoods->refute(branchMark);
     enforceUb();
     if (ToulBar2::isZ && ToulBar2::logepsilon > -numeric_limits<TLogProb>::infinity()) {
         enforceZUb();
     }
     nbBacktracks++;
+    tickTelemetry();
     if (ToulBar2::restart > 0 && nbBacktracks > nbBacktracksLimit)
         throw NbBacktracksOut();
 #ifdef OPENMPI
@@ -1148,7 +1254,8 @@ void Solver::binaryChoicePointLDS(int varIndex, Value value, int discrepancy) {
     bool dichotomic = (ToulBar2::dichotomicBranching && ToulBar2::dichotomicBranchingSize < domsize);
     Value middle = domsize / 2;
     bool increasing = true;
-    ValueCost sorted[domsize];
+    ScratchScope scope(scratch);
+    ValueCost* sorted = scratch.alloc<ValueCost>(domsize);
     if (dichotomic) {
         if (ToulBar2::dichotomicBranching == 1) {
             middle = (wcsp->getInf(varIndex) + wcsp->getSup(varIndex)) / 2;
@@ -1187,6 +1294,9 @@ void Solver::binaryChoicePointLDS(int varIndex, Value value, int discrepancy) {
         Store::restore();
         enforceUb();
         nbBacktracks++;
+        tickTelemetry();
+        if (ldsShared && (nbBacktracks % 64) == 0)
+            syncLDSIncumbent(false);
         if (ToulBar2::restart > 0 && nbBacktracks > nbBacktracksLimit)
             throw NbBacktracksOut();
 #ifdef OPENMPI
@@ -1270,6 +1380,7 @@ void Solver::scheduleOrPostpone(int varIndex) {
     Store::restore();
     enforceUb();
     nbBacktracks++;
+    tickTelemetry();
     if (ToulBar2::restart > 0 && nbBacktracks > nbBacktracksLimit)
         throw NbBacktracksOut();
 #ifdef OPENMPI
@@ -1287,13 +1398,14 @@ void Solver::narySortedChoicePoint(int varIndex, Cost lb) {
 
     assert(wcsp->enumerated(varIndex));
     int size = wcsp->getDomainSize(varIndex);
-    ValueCost sorted[size];
-    //ValueCost* sorted = new ValueCost [size];
+    ScratchScope scope(scratch);
+    ValueCost* sorted = scratch.alloc<ValueCost>(size);
     wcsp->getEnumDomainAndCost(varIndex, sorted);
     qsort(sorted, size, sizeof(ValueCost), cmpValueCost);
     for (int v = 0; wcsp->getLb() < wcsp->getUb() && v < size; v++) {
         if (ToulBar2::interrupted)
             throw TimeOut();
+        size_t branchMark = (nogoods) ? nogoods->mark() : 0;
         try {
             Store::store();
             assign(varIndex, sorted[v].value);
@@ -1302,10 +1414,12 @@ void Solver::narySortedChoicePoint(int varIndex, Cost lb) {
             wcsp->whenContradiction();
         }
         Store::restore();
+        if (nogoods)
+            nogoods->refute(branchMark);
     }
-    //delete [] sorted;
     enforceUb();
     nbBacktracks++;
+    tickTelemetry();
     if (ToulBar2::restart > 0 && nbBacktracks > nbBacktracksLimit)
         throw NbBacktracksOut();
 #ifdef OPENMPI
@@ -1317,8 +1431,8 @@ void Solver::narySortedChoicePoint(int varIndex, Cost lb) {
 void Solver::narySortedChoicePointLDS(int varIndex, int discrepancy) {
     assert(wcsp->enumerated(varIndex));
     int size = wcsp->getDomainSize(varIndex);
-    ValueCost sorted[size];
-    //ValueCost* sorted = new ValueCost [size];
+    ScratchScope scope(scratch);
+    ValueCost* sorted = scratch.alloc<ValueCost>(size);
     wcsp->getEnumDomainAndCost(varIndex, sorted);
     qsort(sorted, size, sizeof(ValueCost), cmpValueCost);
     if (discrepancy < size - 1)
@@ -1335,9 +1449,11 @@ void Solver::narySortedChoicePointLDS(int varIndex, int discrepancy) {
         }
         Store::restore();
     }
-    //delete [] sorted;
     enforceUb();
     nbBacktracks++;
+    tickTelemetry();
+    if (ldsShared && (nbBacktracks % 64) == 0)
+        syncLDSIncumbent(false);
     if (ToulBar2::restart > 0 && nbBacktracks > nbBacktracksLimit)
         throw NbBacktracksOut();
 #ifdef OPENMPI
@@ -1354,8 +1470,8 @@ void Solver::singletonConsistency() {
         for (unsigned int varIndex = 0; varIndex < ((ToulBar2::nbDecisionVars > 0) ? ToulBar2::nbDecisionVars
                                                                                    : wcsp->numberOfVariables()); varIndex++) {
             int size = wcsp->getDomainSize(varIndex);
-            ValueCost sorted[size];
-            //ValueCost* sorted = new ValueCost [size];
+            ScratchScope scope(scratch);
+            ValueCost* sorted = scratch.alloc<ValueCost>(size);
             wcsp->iniSingleton();
             wcsp->getEnumDomainAndCost(varIndex, sorted);
             qsort(sorted, size, sizeof(ValueCost), cmpValueCost);
@@ -1382,7 +1498,6 @@ void Solver::singletonConsistency() {
                 }
             }
             wcsp->removeSingleton();
-            //delete [] sorted;
         }
     }
     if (ToulBar2::verbose >= 0)
@@ -1394,6 +1509,26 @@ void Solver::singletonConsistency() {
  *
  */
 
+void Solver::replaySolution(const Value *values) {
+    vector<int> variables;
+    vector<Value> assignment;
+    for (unsigned int i = 0; i < wcsp->numberOfVariables(); i++) {
+        if (wcsp->unassigned(i)) {
+            variables.push_back(i);
+            assignment.push_back(values[i]);
+        }
+    }
+    int depth = Store::getDepth();
+    try {
+        Store::store();
+        wcsp->assignLS(variables, assignment);
+        newSolution();
+    } catch (Contradiction) {
+        wcsp->whenContradiction();
+    }
+    Store::restore(depth);
+}
+
 void Solver::newSolution() {
     assert(unassignedVars->empty());
 #ifndef NDEBUG
@@ -1406,9 +1541,11 @@ void Solver::newSolution() {
     }
     assert(allVarsAssigned);
 #endif
-    if (!ToulBar2::allSolutions && !ToulBar2::isZ)
+    if (!ToulBar2::allSolutions && !ToulBar2::isZ) {
         wcsp->updateUb(wcsp->getLb());
-    else if (!ToulBar2::btdMode)
+        if (telemetry)
+            writeTelemetry("solution", true);
+    } else if (!ToulBar2::btdMode)
         nbSol += 1.;
 
     if (ToulBar2::isZ) { // Add new solutions to logZ
@@ -1443,6 +1580,8 @@ void Solver::newSolution() {
     wcsp->restoreSolution();
     if (!ToulBar2::isZ)
         wcsp->setSolution(wcsp->getLb());
+    if (ldsShared)
+        syncLDSIncumbent(true);
 
     if (ToulBar2::cpd) {
         //        cout << "Energy " << wcsp->getDLb() << endl;
@@ -1567,6 +1706,12 @@ int currentNode = 0;
 void Solver::recursiveSolve(Cost lb) {
     currentNode++;
 
+    if (ToulBar2::dynamicComponents > 0 && nbNodes >= componentNextNode) {
+        componentNextNode = nbNodes + ToulBar2::dynamicComponents;
+        if (solveComponents())
+            return;
+    }
+
     /* Plug in NN here
     float minEstimatedNodes = std::numeric_limits<float>::max();
     int bestVar = -1;
@@ -1747,12 +1892,12 @@ std::vector<Double> Solver::getFeatureVector(int varIndex, Value val) {
 
     // Find unary cost statistics of certain variable
     std::vector<Double> unaryCosts;
-    ValueCost *valuesAndCosts = new ValueCost[wcsp->getDomainSize(varIndex)];
+    ScratchScope scope(scratch);
+    ValueCost* valuesAndCosts = scratch.alloc<ValueCost>(wcsp->getDomainSize(varIndex));
     wcsp->getEnumDomainAndCost(varIndex, valuesAndCosts);
     for (unsigned int i = 0; i < wcsp->getDomainSize(varIndex); i++) {
         unaryCosts.push_back((Double) valuesAndCosts[i].cost);
     }
-    delete valuesAndCosts;
     std::sort(unaryCosts.begin(), unaryCosts.end());
     Double meanUnaryCost = mean(unaryCosts);
     Double medianUnaryCost = median(unaryCosts);
@@ -1771,7 +1916,7 @@ std::vector<Double> Solver::getFeatureVector(int varIndex, Value val) {
     int numTotalConstraints = wcsp->numberOfConstraints();
 
     // Now get the pairwise costs
-    std::vector<Variable*> variables = wcsp->getVars();
+    const std::vector<Variable*>& variables = wcsp->getVars();
     Variable* currVar = variables.at(varIndex);
 
     std::vector<Double> binaryCosts;
@@ -1892,6 +2037,9 @@ pair<Cost, Cost> Solver::hybridSolve(Cluster *cluster, Cost clb, Cost cub) {
                 delete open;
             open = new OpenList();
             open_ = open;
+            checkpointLastTime = realTime();
+            if (ToulBar2::resume && readCheckpoint(clb))
+                cub = wcsp->getUb();
         }
         cp_->store();
         if (open_->size() == 0 || (cluster && (clb >= open_->getClosedNodesLb(delta) || cub > open_->getUb(
@@ -1973,6 +2121,10 @@ pair<Cost, Cost> Solver::hybridSolve(Cluster *cluster, Cost clb, Cost cub) {
             }
             clb = MAX(clb, open_->getLb(delta));
             showGap(clb, cub);
+            if (telemetry)
+                writeTelemetry("hbfs");
+            if (!cluster && !ToulBar2::checkpointFile.empty() && realTime() - checkpointLastTime >= ToulBar2::checkpointPeriod)
+                writeCheckpoint(initiallb);
             if (ToulBar2::hbfs && nbRecomputationNodes >
                                   0) { // wait until a nonempty open node is restored (at least after first global solution is found)
                 assert(nbNodes > 0);
@@ -2096,6 +2248,17 @@ Cost Solver::beginSolve(Cost ub) {
         ToulBar2::logU = -numeric_limits<TLogProb>::infinity();
     }
 
+    openTelemetry();
+
+    delete nogoods;
+    nogoods = NULL;
+    if (ToulBar2::maxNogoods > 0) {
+        nogoods = new NogoodStore(wcsp);
+        ToulBar2::setmin = nogoodEvent;
+        ToulBar2::setmax = nogoodEvent;
+        ToulBar2::removevalue = nogoodEvent;
+    }
+
     return ub;
 }
 
@@ -2149,7 +2312,10 @@ Cost Solver::preprocessing(Cost initialUpperBound) {
     ToulBar2::lds = lds;
 
     if (ToulBar2::singletonConsistency) {
-        singletonConsistency();
+        if (ToulBar2::sacJobs > 1)
+            parallelSingletonConsistency();
+        else
+            singletonConsistency();
         wcsp->propagate();
     }
 
@@ -2222,6 +2388,8 @@ bool Solver::solve() {
     try {
         try {
             initialUpperBound = preprocessing(initialUpperBound);
+            if (ToulBar2::dynamicComponents > 0)
+                initComponents();
 
             if (ToulBar2::isZ) {
                 if (ToulBar2::sigma > 0 && ToulBar2::GlobalLogUbZ - ToulBar2::GlobalLogLbZ <= Log1p(ToulBar2::sigma))
@@ -2265,7 +2433,8 @@ bool Solver::solve() {
                                  << wcsp->getUb() << " ****** (" << nbNodes << " nodes)" << endl;
                         if (ToulBar2::debug >= 1 && ToulBar2::weightedDegree > 0) {
                             int size = unassignedVars->getSize();
-                            ValueCost sorted[size];
+                            ScratchScope scope(scratch);
+                            ValueCost* sorted = scratch.alloc<ValueCost>(size);
                             int i = 0;
                             for (BTList<Value>::iterator iter = unassignedVars->begin();
                                  iter != unassignedVars->end(); ++iter) {
@@ -2289,6 +2458,8 @@ bool Solver::solve() {
                     upperbound = wcsp->getUb();
                     enforceUb();
                     wcsp->propagate();
+                    if (nogoods)
+                        propagateNogoods();
                     Store::store();
                     if (ToulBar2::isZ) {
                         ToulBar2::logZ = -numeric_limits<TLogProb>::infinity();
@@ -2304,7 +2475,7 @@ bool Solver::solve() {
                                     cout << "--- [" << Store::getDepth() << "] Search with no discrepancy limit --- ("
                                          << nbNodes << " nodes)" << endl;
                             } else {
-                                if (ToulBar2::verbose >= 0)
+                                if (ToulBar2::verbose >= 0 && ToulBar2::ldsJobs <= 1)
                                     cout << "--- [" << Store::getDepth() << "] LDS " << discrepancy << " --- ("
                                          << nbNodes << " nodes)" << endl;
                             }
@@ -2335,6 +2506,8 @@ bool Solver::solve() {
                                     wcsp->setUb(initialUpperBound);
                                 }
 #endif
+                            } else if (ToulBar2::ldsJobs > 1) {
+                                discrepancy = parallelLDS(discrepancy);
                             } else {
                                 try {
                                     Store::store();
@@ -2460,6 +2633,11 @@ bool Solver::solve() {
                     ToulBar2::limited = false;
                 }
                 Store::restore(storedepth);
+                if (nogoods && nbbacktracksout) {
+                    nogoods->record();
+                    if (ToulBar2::verbose >= 1)
+                        cout << "c " << nogoods->size() << " nogoods (" << nogoods->nbRecorded << " recorded, " << nogoods->nbPropagations << " prunings, " << nogoods->nbConflicts << " conflicts)" << endl;
+                }
             } while (nbbacktracksout);
         } catch (Contradiction) {
             wcsp->whenContradiction();
@@ -2478,6 +2656,9 @@ void Solver::endSolve(bool isSolution, Cost cost, bool isComplete) {
 
     int isLimited = (!isComplete) | ((ToulBar2::deltaUb != MIN_COST) << 1);
 
+    if (telemetry)
+        writeTelemetry((isComplete) ? "complete" : "end", true);
+
     if (ToulBar2::isZ) {
         if (ToulBar2::verbose >= 1)
             cout << "NegativeShiftingCost= " << wcsp->getNegativeLb() << endl;
@@ -2553,6 +2734,15 @@ void Solver::endSolve(bool isSolution, Cost cost, bool isComplete) {
     if (ToulBar2::vac)
         wcsp->printVACStat();
 
+    if (ToulBar2::verbose >= 0 && ToulBar2::propagationWaves)
+        cout << "AC waves: " << ((WCSP*)wcsp)->getNbWaveRemoves() << " variable revisions merged into " << ((WCSP*)wcsp)->getNbWaveRevisions() << " cost function revisions" << endl;
+
+    if (ToulBar2::verbose >= 0 && ToulBar2::dynamicComponents > 0)
+        cout << "Independent subproblems: " << nbComponentSplits << " decompositions and " << nbComponentHits << " cache hits" << endl;
+
+    if (ToulBar2::verbose >= 0 && nogoods)
+        cout << "Nogoods from restarts: " << nogoods->nbRecorded << " recorded (" << nogoods->size() << " kept), " << nogoods->nbPropagations << " prunings and " << nogoods->nbConflicts << " conflicts" << endl;
+
     if (ToulBar2::verbose >= 0 && nbHybrid >= 1 && nbNodes > 0)
         cout << "Node redundancy during HBFS: " << 100. * nbRecomputationNodes / nbNodes << " %" << endl;
 
@@ -2888,8 +3078,9 @@ void Solver::restore(CPStore &cp, OpenNode nd) {
     nbRecomputationNodes += nd.last - nd.first;
 
     ptrdiff_t maxsize = nd.last - nd.first;
-    int assignLS[maxsize];
-    Value valueLS[maxsize];
+    ScratchScope scope(scratch); // branches may be too long for the C stack
+    int* assignLS = scratch.alloc<int>(maxsize);
+    Value* valueLS = scratch.alloc<Value>(maxsize);
     unsigned int size = 0;
     for (ptrdiff_t idx = nd.first; idx < nd.last; ++idx) {
         assert((size_t) idx < cp.size());
@@ -8,6 +8,7 @@
 
 #include "toulbar2lib.hpp"
 #include "utils/tb2store.hpp"
+#include "utils/tb2scratch.hpp"
 
 template <class T>
 class DLink;
@@ -190,6 +191,63 @@ public:
     void addOpenNode(CPStore& cp, OpenList& open, Cost lb, TLogProb logLbZ, TLogProb logUbZ, Cost delta = MIN_COST);
     void restore(CPStore& cp, OpenNode node);
 
+    /// \brief reduced nld-nogoods extracted from the search branch at each restart and propagated by watched literals
+    /// \see <em> Recording and Minimizing Nogoods from Restarts </em>. Christophe Lecoutre, Lakhdar Sais, Sebastien Tabary, Vincent Vidal. JSAT 1:147-167, 2007.
+    class NogoodStore FINAL {
+        struct Literal {
+            ChoicePointOp op; // CP_ASSIGN (x=v), CP_REMOVE (x!=v), CP_INCREASE (x>=v), or CP_DECREASE (x<=v)
+            int varIndex;
+            Value value;
+        };
+        struct Decision {
+            Literal lit;
+            Long node; // decisions of the same search node (e.g. removing a range of values) share the same node number
+            bool refuted; // true if the subtree below this (left) decision has been fully explored
+        };
+        struct Nogood {
+            vector<Literal> lits; // forbidden conjunction of decisions, the first two literals are watched
+            double activity; // bumped each time the nogood prunes a value or fails
+        };
+
+        WeightedCSP* wcsp;
+        vector<Decision> branch; // decisions taken since the last restart
+        vector<Nogood*> nogoods;
+        vector<vector<Nogood*>> watches; // nogoods watching a literal on each variable
+        vector<int> pending; // variables whose domain changed since the last propagation
+        vector<bool> queued;
+        double activityInc;
+
+        bool entailed(const Literal& lit) const;
+        bool falsified(const Literal& lit) const;
+        void enforceNegation(const Literal& lit);
+        void bump(Nogood* ng);
+        void add(vector<Literal>& lits);
+        void reduce();
+
+    public:
+        Long nbRecorded;
+        Long nbPropagations;
+        Long nbConflicts;
+        Long nbDeleted;
+
+        NogoodStore(WeightedCSP* wcsp);
+        ~NogoodStore();
+
+        size_t size() const { return nogoods.size(); }
+        size_t mark() const { return branch.size(); }
+        void decide(ChoicePointOp op, int varIndex, Value value, Long node) { branch.push_back({ { op, varIndex, value }, node, false }); }
+        void refute(size_t mark);
+        void record();
+        void notify(int varIndex)
+        {
+            if (!queued[varIndex] && !watches[varIndex].empty()) {
+                queued[varIndex] = true;
+                pending.push_back(varIndex);
+            }
+        }
+        bool propagate();
+    };
+
 protected:
     friend class NeighborhoodStructure;
     friend class RandomNeighborhoodChoice;
@@ -204,6 +262,7 @@ protected:
     BTList<Value>* unassignedVars;
     int lastConflictVar;
     void* searchSize;
+    Scratch scratch; // temporary arrays of the heuristics and choice points of the current branch (see ScratchScope)
 
     BigInteger nbSol;
     int nbSoldiv = 0;
@@ -221,8 +280,34 @@ protected:
     Long nbHybridNew;
     Long nbRecomputationNodes;
 
+    NogoodStore* nogoods; // nogoods recorded from restarts (NULL if ToulBar2::maxNogoods is zero)
+    void propagateNogoods();
+
+    // dynamic decomposition into independent subproblems (see ToulBar2::dynamicComponents)
+    vector<vector<int>> componentNeighbors; // constraint graph at the root of the search
+    map<vector<Value>, vector<Value>> componentCache; // optimal assignment of a subproblem given its current domains and the values of its assigned neighbors
+    Long componentNextNode;
+    Long nbComponentSplits;
+    Long nbComponentHits;
+    void initComponents();
+    bool solveComponents();
+    void solveComponent(const vector<int>& vars, Cost lbAtNode, Cost& bound, vector<Value>& best);
+
     ofstream dataFile;
 
+    // JSON telemetry stream of search progress (see ToulBar2::telemetryFile)
+    FILE* telemetry;
+    double telemetryStartTime;
+    double telemetryLastTime;
+    Long telemetryLastNodes;
+    void openTelemetry();
+    void writeTelemetry(const char* event, bool force = false);
+    void tickTelemetry()
+    {
+        if (telemetry && (nbBacktracks % 64) == 0)
+            writeTelemetry("search");
+    }
+
     //only for pretty print of optimality gap information
     Cost initialLowerBound;
     Cost globalLowerBound;
@@ -260,6 +345,7 @@ protected:
     void enforceUb();
     void enforceZUb(Cluster* cluster = NULL);
     void singletonConsistency();
+    void parallelSingletonConsistency();
     Cost beginSolve(Cost ub);
     Cost preprocessing(Cost ub);
     void endSolve(bool isSolution, Cost cost, bool isComplete);
@@ -271,6 +357,17 @@ protected:
     void narySortedChoicePointLDS(int xIndex, int discrepancy);
     void recursiveSolve(Cost lb = MIN_COST);
     void recursiveSolveLDS(int discrepancy);
+
+    void* ldsShared; // incumbent shared between parallel LDS processes (NULL if sequential)
+    int parallelLDS(int discrepancy);
+    void syncLDSIncumbent(bool publish);
+
+    void replaySolution(const Value* values); ///< \brief reports a complete assignment found elsewhere as a new solution (values in variable index order)
+
+    // checkpoint of hybrid best-first search (see ToulBar2::checkpointFile)
+    double checkpointLastTime;
+    void writeCheckpoint(Cost rootLb);
+    bool readCheckpoint(Cost rootLb);
     Value postponeRule(int varIndex);
     void scheduleOrPostpone(int varIndex);
 
@@ -334,6 +431,7 @@ public:
     Cost getSolution(vector<Value>& solution);
 
     friend void setvalue(int wcspId, int varIndex, Value value, void* solver);
+    friend void nogoodEvent(int wcspId, int varIndex, Value value, void* solver);
 
     WeightedCSP* getWCSP() FINAL { return wcsp; }
 };
@@ -368,6 +466,8 @@ public:
     }
 };
 
+void nogoodEvent(int wcspId, int varIndex, Value value, void* solver);
+
 int solveSymMax2SAT(int n, int m, int* posx, int* posy, double* cost, int* sol);
 extern "C" int solvesymmax2sat_(int* n, int* m, int* posx, int* posy, double* cost, int* sol);
 
@@ -3,6 +3,7 @@
  */
 
 #include "toulbar2lib.hpp"
+#include "core/tb2costkernels.hpp"
 #include "applis/tb2pedigree.hpp"
 #include "applis/tb2haplotype.hpp"
 #include "applis/tb2bep.hpp"
@@ -26,6 +27,8 @@
 
 const int maxdiscrepancy = 4;
 const Long maxrestarts = 10000;
+const int maxnogoods = 100000;
+const int dyncompperiod = 16;
 const Long hbfsgloballimit = 10000;
 
 // INCOP default command line option
@@ -214,27 +217,47 @@ enum {
     OPT_trwsNIterComputeUb,
     NO_OPT_trws,
     OPT_costMultiplier,
+    OPT_sparse,
+    NO_OPT_sparse,
+    OPT_sparseTernary,
+    NO_OPT_sparseTernary,
     OPT_deltaUb,
     OPT_singletonConsistency,
     NO_OPT_singletonConsistency,
+    OPT_sacJobs,
     OPT_vacValueHeuristic,
     NO_OPT_vacValueHeuristic,
+    OPT_vacWarmStart,
+    NO_OPT_vacWarmStart,
     OPT_preprocessTernary,
     NO_OPT_preprocessTernary,
     OPT_preprocessFunctional,
     NO_OPT_preprocessFunctional,
     OPT_preprocessNary,
     NO_OPT_preprocessNary,
+    OPT_preprocessThreads,
+    OPT_costKernels,
     OPT_QueueComplexity,
     NO_OPT_QueueComplexity,
+    OPT_waves,
+    NO_OPT_waves,
     OPT_MSTDAC,
     NO_OPT_MSTDAC,
     OPT_DEE,
     NO_OPT_DEE,
+    OPT_DEEMatrix,
+    NO_OPT_DEEMatrix,
+    OPT_interchangeableValues,
+    NO_OPT_interchangeableValues,
     OPT_lds,
     NO_OPT_lds,
+    OPT_ldsJobs,
     OPT_restart,
     NO_OPT_restart,
+    OPT_nogoods,
+    NO_OPT_nogoods,
+    OPT_dyncomp,
+    NO_OPT_dyncomp,
     OPT_hbfs,
     NO_OPT_hbfs,
     OPT_open,
@@ -268,6 +291,11 @@ enum {
 
     OPT_learning,
     OPT_timer,
+    OPT_telemetry,
+    OPT_telemetryPeriod,
+    OPT_checkpoint,
+    OPT_checkpointPeriod,
+    OPT_resume,
 #ifndef NDEBUG
     OPT_verifyopt,
 #endif
@@ -430,9 +458,15 @@ CSimpleOpt::SOption g_rgOptions[] = {
     { NO_OPT_vac, (char*)"-A:", SO_NONE },
     { OPT_vacValueHeuristic, (char*)"-V", SO_NONE },
     { NO_OPT_vacValueHeuristic, (char*)"-V:", SO_NONE },
+    { OPT_vacWarmStart, (char*)"-vacwarm", SO_NONE },
+    { NO_OPT_vacWarmStart, (char*)"-vacwarm:", SO_NONE },
     { OPT_costThreshold, (char*)"-T", SO_REQ_SEP },
     { OPT_costThresholdPre, (char*)"-P", SO_REQ_SEP },
     { OPT_costMultiplier, (char*)"-C", SO_REQ_SEP },
+    { OPT_sparse, (char*)"-sparse", SO_REQ_SEP },
+    { NO_OPT_sparse, (char*)"-sparse:", SO_NONE },
+    { OPT_sparseTernary, (char*)"-sparset", SO_REQ_SEP },
+    { NO_OPT_sparseTernary, (char*)"-sparset:", SO_NONE },
     { OPT_deltaUb, (char*)"-agap", SO_REQ_SEP },
     { NO_OPT_trws, (char*)"-trws:", SO_NONE },
     { OPT_trwsAccuracy, (char*)"-trws", SO_OPT },
@@ -446,22 +480,36 @@ CSimpleOpt::SOption g_rgOptions[] = {
     //preprocessing
     { OPT_minsumDiffusion, (char*)"-M", SO_REQ_SEP },
     { OPT_singletonConsistency, (char*)"-S", SO_NONE },
+    { OPT_sacJobs, (char*)"-sacjobs", SO_REQ_SEP },
     { OPT_preprocessTernary, (char*)"-t", SO_OPT },
     { NO_OPT_preprocessTernary, (char*)"-t:", SO_NONE },
     { OPT_preprocessFunctional, (char*)"-f", SO_OPT },
     { NO_OPT_preprocessFunctional, (char*)"-f:", SO_NONE },
     { OPT_preprocessNary, (char*)"-n", SO_OPT },
     { NO_OPT_preprocessNary, (char*)"-n:", SO_NONE },
+    { OPT_preprocessThreads, (char*)"-prethreads", SO_REQ_SEP },
+    { OPT_costKernels, (char*)"-kernels", SO_REQ_SEP },
 
     { OPT_QueueComplexity, (char*)"-o", SO_NONE },
+    { OPT_waves, (char*)"-waves", SO_NONE },
+    { NO_OPT_waves, (char*)"-waves:", SO_NONE },
     { OPT_MSTDAC, (char*)"-mst", SO_NONE },
     { NO_OPT_MSTDAC, (char*)"-mst:", SO_NONE },
     { OPT_DEE, (char*)"-dee", SO_OPT },
     { NO_OPT_DEE, (char*)"-dee:", SO_OPT },
+    { OPT_DEEMatrix, (char*)"-deematrix", SO_NONE },
+    { NO_OPT_DEEMatrix, (char*)"-deematrix:", SO_NONE },
+    { OPT_interchangeableValues, (char*)"-interchange", SO_NONE },
+    { NO_OPT_interchangeableValues, (char*)"-interchange:", SO_NONE },
     { OPT_lds, (char*)"-l", SO_OPT },
     { NO_OPT_lds, (char*)"-l:", SO_NONE },
+    { OPT_ldsJobs, (char*)"-ldsjobs", SO_REQ_SEP },
     { OPT_restart, (char*)"-L", SO_OPT },
     { NO_OPT_restart, (char*)"-L:", SO_NONE },
+    { OPT_nogoods, (char*)"-nogoods", SO_OPT },
+    { NO_OPT_nogoods, (char*)"-nogoods:", SO_NONE },
+    { OPT_dyncomp, (char*)"-dyncomp", SO_OPT },
+    { NO_OPT_dyncomp, (char*)"-dyncomp:", SO_NONE },
     { OPT_hbfs, (char*)"-hbfs", SO_OPT },
     { OPT_hbfs, (char*)"-bfs", SO_OPT },
     { NO_OPT_hbfs, (char*)"-hbfs:", SO_NONE },
@@ -507,6 +555,11 @@ CSimpleOpt::SOption g_rgOptions[] = {
     { OPT_verifyopt, (char*)"-opt", SO_NONE }, // for debugging purposes, checks the given optimal solution (problem.sol) is not pruned during search
 #endif
     { OPT_timer, (char*)"-timer", SO_REQ_SEP }, // CPU timer
+    { OPT_telemetry, (char*)"--telemetry", SO_REQ_SEP }, // JSON telemetry stream
+    { OPT_telemetryPeriod, (char*)"--telemetry-period", SO_REQ_SEP },
+    { OPT_checkpoint, (char*)"--checkpoint", SO_REQ_SEP }, // save hybrid best-first search state
+    { OPT_checkpointPeriod, (char*)"--checkpoint-period", SO_REQ_SEP },
+    { OPT_resume, (char*)"--resume", SO_NONE },
 
     // random generator
     { OPT_seed, (char*)"-seed", SO_REQ_SEP },
@@ -760,6 +813,8 @@ void help_msg(char* toulbar2filename)
 #endif
     cout << "   -seed=[integer] : random seed non-negative value or use current time if a negative value is given (default value is " << ToulBar2::seed << ")" << endl;
     cout << "   --stdin=[format] : read file from pipe ; e.g., cat example.wcsp | toulbar2 --stdin=wcsp" << endl;
+    cout << "   --telemetry=[filename] : writes search progress (bounds, nodes, backtracks, node rate, open nodes, memory) as newline-delimited JSON records into a file or a Unix-domain socket given as unix:path" << endl;
+    cout << "   --telemetry-period=[float] : minimum wall-clock time in seconds between two telemetry records (default value is " << ToulBar2::telemetryPeriod << ")" << endl;
     cout << "   -var=[integer] : searches by branching only on the first -the given value- decision variables, assuming the remaining variables are intermediate variables completely assigned by the decision variables (use a zero if all variables are decision variables) (default value is " << ToulBar2::nbDecisionVars << ")" << endl;
     cout << "   -b : searches using binary branching always instead of binary branching for interval domains and n-ary branching for enumerated domains";
     if (ToulBar2::binaryBranching)
@@ -796,6 +851,8 @@ void help_msg(char* toulbar2filename)
         cout << " (default option)";
     cout << endl;
     cout << "   -n=[integer] : preprocessing only: projects n-ary cost functions on all binary cost functions if n is lower than the given value (default value is " << ToulBar2::preprocessNary << ")" << endl;
+    cout << "   -prethreads=[integer] : preprocessing only: number of threads sharing independent computations on each cost function (tightness, storage selection of ternary cost functions, TRW-S messages of nonadjacent variables, VAC pass 1 revisions and min-sum diffusion of nonadjacent variables) with the same result as a single thread (default value is " << ToulBar2::preprocessThreads << ")" << endl;
+    cout << "   -kernels=[integer] : instruction set of the dense kernels over rows and columns of binary cost functions used to find supports and by -deematrix (0: none, iterates over domains, 1: portable loops, 2: AVX2, 3: AVX-512, lowered to the best one supported by the processor) (default value is " << getCostKernels() << ")" << endl;
 #ifdef BOOST
     cout << "   -mst : maximum spanning tree DAC ordering";
     if (ToulBar2::MSTDAC)
@@ -807,16 +864,39 @@ void help_msg(char* toulbar2filename)
     if (ToulBar2::QueueComplexity)
         cout << " (default option)";
     cout << endl;
+    cout << "   -waves : enforces AC by waves, revising each cost function once for all its variables taken together from the AC queue";
+    if (ToulBar2::propagationWaves)
+        cout << " (default option)";
+    cout << endl;
     cout << "   -k=[integer] : soft local consistency level (NC with Strong NIC for global cost functions=0, (G)AC=1, D(G)AC=2, FD(G)AC=3, (weak) ED(G)AC=4) (default value is " << ToulBar2::LcLevel << ")" << endl;
     cout << "   -dee=[integer] : restricted dead-end elimination (value pruning by dominance rule from EAC value (dee>=1 and dee<=3)) and soft neighborhood substitutability (in preprocessing (dee=2 or dee=4) or during search (dee=3)) (default value is " << ToulBar2::DEE << ")" << endl;
+    cout << "   -deematrix : soft neighborhood substitutability (dee>=2) computes maximum cost differences for all pairs of values at once for variables with only binary cost functions (using -prethreads in preprocessing)";
+    if (ToulBar2::DEEMatrix)
+        cout << " (default option)";
+    cout << endl;
+    cout << "   -interchange : merges the values of a variable having the same unary cost and the same binary costs with every value of its neighbors (and the same amino acid in protein design) at load time, solution counting and printing with -a restore the merged values (using -prethreads)";
+    if (ToulBar2::interchangeableValues)
+        cout << " (default option)";
+    cout << endl;
     cout << "   -l=[integer] : limited discrepancy search, use a negative value to stop the search after the given absolute number of discrepancies has been explored (discrepancy bound = " << maxdiscrepancy << " by default)";
     if (ToulBar2::lds)
         cout << " (default option)";
     cout << endl;
+#ifdef LINUX
+    cout << "   -ldsjobs=[integer] : explores the discrepancy levels of limited discrepancy search concurrently using the given number of processes sharing the best solution found (default value is " << ToulBar2::ldsJobs << ")" << endl;
+#endif
     cout << "   -L=[integer] : randomized (quasi-random variable ordering) search with restart (maximum number of nodes/VNS restarts = " << maxrestarts << " by default)";
     if (ToulBar2::restart >= 0)
         cout << " (default option)";
     cout << endl;
+    cout << "   -nogoods=[integer] : records reduced nld-nogoods from the current branch at each restart (with -L option), keeping at most the given number of the most active ones (" << maxnogoods << " by default)";
+    if (ToulBar2::maxNogoods > 0)
+        cout << " (default option)";
+    cout << endl;
+    cout << "   -dyncomp=[integer] : detects independent subproblems every given number of search nodes and solves them separately, caching their optimal assignments (every " << dyncompperiod << " nodes by default)";
+    if (ToulBar2::dynamicComponents > 0)
+        cout << " (default option)";
+    cout << endl;
     cout << "   -i=[\"string\"] : initial upperbound found by INCOP local search solver." << endl;
     cout << "       string parameter is optional, using \"" << Incop_cmd << "\" by default with the following meaning:" << endl;
     cout << "       stoppinglowerbound randomseed nbiterations method nbmoves neighborhoodchoice neighborhoodchoice2 minnbneighbors maxnbneighbors neighborhoodchoice3 autotuning tracemode" << endl;
@@ -851,14 +931,21 @@ void help_msg(char* toulbar2filename)
     cout << "   -T=[decimal] : threshold cost value for VAC (default value is " << ToulBar2::costThreshold << ")" << endl;
     cout << "   -P=[decimal] : threshold cost value for VAC during the preprocessing phase (default value is " << ToulBar2::costThresholdPre << ")" << endl;
     cout << "   -C=[float] : multiplies all costs internally by this number when loading the problem (default value is " << ToulBar2::costMultiplier << ")" << endl;
+    cout << "   -sparse=[float] : stores binary cost functions sparsely (only the tuples not having their most frequent cost) if the proportion of such tuples is at most this number (default value is " << ToulBar2::sparseBinaryDensity << ")" << endl;
+    cout << "   -sparset=[float] : same as -sparse for ternary cost functions which are not functional (default value is " << ToulBar2::sparseTernaryDensity << ")" << endl;
     cout << "   -S : preprocessing only: performs singleton consistency (only in conjunction with option \"-A\")";
     if (ToulBar2::singletonConsistency)
         cout << " (default option)";
     cout << endl;
+    cout << "   -sacjobs=[integer] : shares the probes of singleton consistency (-S) among the given number of processes, each one working on its own copy of the problem (not with VAC) (default value is " << ToulBar2::sacJobs << ")" << endl;
     cout << "   -V : VAC-based value ordering heuristic";
     if (ToulBar2::vacValueHeuristic)
         cout << " (default option)";
     cout << endl;
+    cout << "   -vacwarm : in search (-A with a depth greater than 1), starts the VAC threshold descent from the last threshold which increased the lower bound at the current node or above, instead of the largest cost of the scale";
+    if (ToulBar2::vacWarmStart)
+        cout << " (default option)";
+    cout << endl;
     cout << "   -trws=[float] : enforces TRW-S in preprocessing until a given precision is reached (default value is " << ToulBar2::trwsAccuracy << ")" << endl;
     cout << "   --trws-order : replaces DAC order by Kolmogorov's TRW-S order";
     if (ToulBar2::trwsOrder)
@@ -896,6 +983,9 @@ void help_msg(char* toulbar2filename)
     cout << endl;
     cout << "   -hbfs=[integer] : hybrid best-first search, restarting from the root after a given number of backtracks (default value is " << hbfsgloballimit << ")" << endl;
     cout << "   -open=[integer] : hybrid best-first search limit on the number of open nodes (default value is " << ToulBar2::hbfsOpenNodeLimit << ")" << endl;
+    cout << "   --checkpoint=[filename] : periodically saves the hybrid best-first search state (primal bound, open nodes, heuristic weights) into the given file (without tree decomposition)" << endl;
+    cout << "   --checkpoint-period=[float] : minimum wall-clock time in seconds between two checkpoints (default value is " << ToulBar2::checkpointPeriod << ")" << endl;
+    cout << "   --resume : continues hybrid best-first search from the checkpoint file if it exists (same problem and options required)" << endl;
 
     cout << "---------------------------------------------------------------------------------------" << endl;
     cout << "----------------------------------- Protein Design ------------------------------------" << endl;
@@ -1550,6 +1640,22 @@ int _tmain(int argc, TCHAR* argv[])
                     ToulBar2::costMultiplier = co;
             }
 
+            if (args.OptionId() == OPT_sparse) {
+                double density = atof(args.OptionArg());
+                if (density >= 0.)
+                    ToulBar2::sparseBinaryDensity = density;
+            } else if (args.OptionId() == NO_OPT_sparse) {
+                ToulBar2::sparseBinaryDensity = 0.;
+            }
+
+            if (args.OptionId() == OPT_sparseTernary) {
+                double density = atof(args.OptionArg());
+                if (density >= 0.)
+                    ToulBar2::sparseTernaryDensity = density;
+            } else if (args.OptionId() == NO_OPT_sparseTernary) {
+                ToulBar2::sparseTernaryDensity = 0.;
+            }
+
             if (args.OptionId() == OPT_qpbo_mult) {
                 double co = atof(args.OptionArg());
                 if (co != 0.)
@@ -1558,10 +1664,19 @@ int _tmain(int argc, TCHAR* argv[])
 
             if (args.OptionId() == OPT_singletonConsistency)
                 ToulBar2::singletonConsistency = true;
+            if (args.OptionId() == OPT_sacJobs) {
+                int jobs = atoi(args.OptionArg());
+                if (jobs >= 1)
+                    ToulBar2::sacJobs = jobs;
+            }
             if (args.OptionId() == OPT_vacValueHeuristic)
                 ToulBar2::vacValueHeuristic = true;
             else if (args.OptionId() == NO_OPT_vacValueHeuristic)
                 ToulBar2::vacValueHeuristic = false;
+            if (args.OptionId() == OPT_vacWarmStart)
+                ToulBar2::vacWarmStart = true;
+            else if (args.OptionId() == NO_OPT_vacWarmStart)
+                ToulBar2::vacWarmStart = false;
             if (args.OptionId() == OPT_preprocessTernary) {
                 if (args.OptionArg() != NULL) {
                     int size = atol(args.OptionArg());
@@ -1645,6 +1760,14 @@ int _tmain(int argc, TCHAR* argv[])
                 if (ToulBar2::debug)
                     cout << "dead-end elimination: " << ToulBar2::DEE << endl;
             }
+            if (args.OptionId() == OPT_DEEMatrix)
+                ToulBar2::DEEMatrix = true;
+            else if (args.OptionId() == NO_OPT_DEEMatrix)
+                ToulBar2::DEEMatrix = false;
+            if (args.OptionId() == OPT_interchangeableValues)
+                ToulBar2::interchangeableValues = true;
+            else if (args.OptionId() == NO_OPT_interchangeableValues)
+                ToulBar2::interchangeableValues = false;
 
             // pre projection of nary cost functions
             if (args.OptionId() == OPT_preprocessNary) {
@@ -1664,8 +1787,24 @@ int _tmain(int argc, TCHAR* argv[])
                 ToulBar2::preprocessNary = 0;
             }
 
+            if (args.OptionId() == OPT_preprocessThreads) {
+                int threads = atoi(args.OptionArg());
+                if (threads >= 1)
+                    ToulBar2::preprocessThreads = threads;
+            }
+
+            if (args.OptionId() == OPT_costKernels) {
+                int level = atoi(args.OptionArg());
+                if (level >= COSTKERNELS_NONE)
+                    selectCostKernels(level);
+            }
+
             if (args.OptionId() == OPT_QueueComplexity)
                 ToulBar2::QueueComplexity = true;
+            if (args.OptionId() == OPT_waves)
+                ToulBar2::propagationWaves = true;
+            else if (args.OptionId() == NO_OPT_waves)
+                ToulBar2::propagationWaves = false;
             if (args.OptionId() == OPT_MSTDAC)
                 ToulBar2::MSTDAC = true;
             else if (args.OptionId() == NO_OPT_MSTDAC)
@@ -1694,6 +1833,11 @@ int _tmain(int argc, TCHAR* argv[])
                 if (ToulBar2::debug)
                     cout << "LDS OFF iter = " << ToulBar2::lds << endl;
             }
+            if (args.OptionId() == OPT_ldsJobs) {
+                int jobs = atoi(args.OptionArg());
+                if (jobs >= 1)
+                    ToulBar2::ldsJobs = jobs;
+            }
 
             // restart option
             if (args.OptionId() == OPT_restart) {
@@ -1714,6 +1858,40 @@ int _tmain(int argc, TCHAR* argv[])
                 ToulBar2::restart = -1;
             }
 
+            // nogood recording from restarts
+            if (args.OptionId() == OPT_nogoods) {
+                if (args.OptionArg() == NULL) {
+                    ToulBar2::maxNogoods = maxnogoods;
+                } else {
+                    int maxng = atoi(args.OptionArg());
+                    if (maxng >= 0)
+                        ToulBar2::maxNogoods = maxng;
+                }
+                if (ToulBar2::debug)
+                    cout << "nogood recording ON with at most " << ToulBar2::maxNogoods << " nogoods" << endl;
+            } else if (args.OptionId() == NO_OPT_nogoods) {
+                if (ToulBar2::debug)
+                    cout << "nogood recording OFF" << endl;
+                ToulBar2::maxNogoods = 0;
+            }
+
+            // dynamic decomposition into independent subproblems
+            if (args.OptionId() == OPT_dyncomp) {
+                if (args.OptionArg() == NULL) {
+                    ToulBar2::dynamicComponents = dyncompperiod;
+                } else {
+                    int period = atoi(args.OptionArg());
+                    if (period >= 0)
+                        ToulBar2::dynamicComponents = period;
+                }
+                if (ToulBar2::debug)
+                    cout << "dynamic decomposition ON every " << ToulBar2::dynamicComponents << " nodes" << endl;
+            } else if (args.OptionId() == NO_OPT_dyncomp) {
+                if (ToulBar2::debug)
+                    cout << "dynamic decomposition OFF" << endl;
+                ToulBar2::dynamicComponents = 0;
+            }
+
             // hybrid BFS option
             if (args.OptionId() == OPT_hbfs) {
                 string comment;
@@ -2047,6 +2225,29 @@ int _tmain(int argc, TCHAR* argv[])
                 }
             }
 
+            // search telemetry
+            if (args.OptionId() == OPT_telemetry) {
+                ToulBar2::telemetryFile = args.OptionArg();
+            }
+            if (args.OptionId() == OPT_telemetryPeriod) {
+                double period = atof(args.OptionArg());
+                if (period >= 0)
+                    ToulBar2::telemetryPeriod = period;
+            }
+
+            // checkpoint and resume
+            if (args.OptionId() == OPT_checkpoint) {
+                ToulBar2::checkpointFile = args.OptionArg();
+            }
+            if (args.OptionId() == OPT_checkpointPeriod) {
+                double period = atof(args.OptionArg());
+                if (period >= 0)
+                    ToulBar2::checkpointPeriod = period;
+            }
+            if (args.OptionId() == OPT_resume) {
+                ToulBar2::resume = true;
+            }
+
             //////////RANDOM GENERATOR///////
             if (args.OptionId() == OPT_seed) {
                 int seed = atoi(args.OptionArg());
@@ -2715,6 +2916,8 @@ int _tmain(int argc, TCHAR* argv[])
         }
         if (ToulBar2::cpd)
             solver->applyCompositionalBiases();
+        if (ToulBar2::interchangeableValues)
+            solver->getWCSP()->mergeInterchangeableValues();
 
         if (ToulBar2::dumpWCSP == 1) {
             string problemname = ToulBar2::problemsaved_filename;
@@ -152,6 +152,10 @@ public:
     virtual void resetWeightedDegree(int varIndex) = 0; ///< \brief initialize weighted degree heuristic
 
     virtual void preprocessing() = 0; ///< \brief applies various preprocessing techniques to simplify the current problem
+    /// \brief removes the values having the same unary cost, the same binary costs with every value of the neighbors and the same amino acid in protein design as a remaining value of their variable (see ToulBar2 option \e -interchange)
+    /// \note to be done after loading the problem and before solving it, the removed values are recorded for solution counting and printing
+    virtual void mergeInterchangeableValues() = 0;
+    virtual const vector<Value>& getInterchangeableValues(int varIndex, Value value) const = 0; ///< \brief values merged into the remaining \e value of variable \e varIndex (empty if none)
     /// \brief sorts the list of cost functions associated to each variable based on smallest problem variable indexes
     /// \warning side-effect: updates DAC order according to an existing variable elimination order
     /// \note must be called after creating all the cost functions and before solving the problem
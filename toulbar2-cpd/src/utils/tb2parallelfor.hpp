@@ -0,0 +1,67 @@
+/** \file tb2parallelfor.hpp
+ *  \brief Independent iterations shared among threads.
+ *
+ * Used by preprocessing steps made of independent computations on each cost function or variable.
+ * Each iteration must only modify data owned by its index, such that the result does not depend on
+ * the number of threads nor on their scheduling.
+ *
+ * \warning storable data can only be modified at depth 0 inside iterations (trailing stacks are not thread-safe)
+ */
+
+#ifndef TB2PARALLELFOR_HPP_
+#define TB2PARALLELFOR_HPP_
+
+#include "core/tb2types.hpp"
+#include <atomic>
+#include <exception>
+#include <thread>
+
+/// \brief calls \a f(i) for each \e i in [0, \a n) using at most \a nbThreads threads (the calling thread included)
+/// \note iterations are taken one at a time from a shared counter to balance cost functions of different sizes
+/// \note if some iterations throw an exception, the one of the smallest index is rethrown after all threads have finished
+template <class F>
+void parallelFor(size_t n, int nbThreads, F f)
+{
+    if (nbThreads <= 1 || n <= 1) {
+        for (size_t i = 0; i < n; i++)
+            f(i);
+        return;
+    }
+    nbThreads = (int)min((size_t)nbThreads, n);
+    std::atomic<size_t> next(0);
+    vector<std::exception_ptr> errors(nbThreads);
+    vector<size_t> errorIndexes(nbThreads, n);
+    auto work = [&](int thread) {
+        for (size_t i = next++; i < n; i = next++) {
+            try {
+                f(i);
+            } catch (...) {
+                if (i < errorIndexes[thread]) {
+                    errors[thread] = std::current_exception();
+                    errorIndexes[thread] = i;
+                }
+            }
+        }
+    };
+    vector<std::thread> threads;
+    for (int t = 1; t < nbThreads; t++)
+        threads.emplace_back(work, t);
+    work(0);
+    for (unsigned int t = 0; t < threads.size(); t++)
+        threads[t].join();
+    int first = -1;
+    for (int t = 0; t < nbThreads; t++)
+        if (errors[t] && (first < 0 || errorIndexes[t] < errorIndexes[first]))
+            first = t;
+    if (first >= 0)
+        std::rethrow_exception(errors[first]);
+}
+
+#endif /*TB2PARALLELFOR_HPP_*/
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
@@ -42,6 +42,14 @@ Variable* Queue::pop(int* incdec)
     return pop();
 }
 
+void Queue::top(vector<Variable*>& vars, int n)
+{
+    vars.clear();
+    for (iterator iter = rbegin(); iter != rend() && (int)vars.size() < n; --iter) {
+        vars.push_back((*iter).var);
+    }
+}
+
 Variable* Queue::pop_min()
 {
     assert(!empty());
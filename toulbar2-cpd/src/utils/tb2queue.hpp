@@ -47,6 +47,8 @@ public:
     Variable* pop_max(int* incdec);
     Variable* pop_first();
 
+    void top(vector<Variable*>& vars, int n); ///< \brief the (at most) \a n next variables returned by Queue::pop, in that order
+
     void print(ostream& o);
 };
 
@@ -24,8 +24,10 @@
 #include <boost/iostreams/filter/gzip.hpp>
 #if (BOOST_VERSION >= 106500)
 #include <boost/iostreams/filter/lzma.hpp>
+#if (BOOST_VERSION < 107000)
 #include "lzma-cpp.inc"
 #endif
+#endif
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/compressed_pair.hpp>
@@ -0,0 +1,92 @@
+/** \file tb2scratch.hpp
+ *  \brief Temporary arrays of search nodes.
+ *
+ * A stack of memory chunks where arrays are allocated by moving a pointer and released together by the
+ * ScratchScope created before them, in the reverse order of the scopes (including when an exception such as
+ * Contradiction unwinds the search). The chunks are kept for the next nodes, such that the arrays of the
+ * value and variable ordering heuristics and of the choice points do not allocate heap memory after the first
+ * nodes, and large domains or long branches do not overflow the C stack as variable-length arrays would.
+ *
+ * \warning only for trivial types (no constructor nor destructor is called)
+ */
+
+#ifndef TB2SCRATCH_HPP_
+#define TB2SCRATCH_HPP_
+
+#include "core/tb2types.hpp"
+
+class Scratch {
+    static const size_t ChunkSize = 65536; ///< default size in bytes of a chunk
+    static const size_t Alignment = 16; ///< alignment in bytes of the arrays (as returned by new)
+
+    vector<vector<char>> chunks;
+    size_t current; ///< index of the chunk of the last array
+    size_t used; ///< number of bytes used in the current chunk
+
+    void* allocate(size_t bytes)
+    {
+        bytes = (bytes + Alignment - 1) / Alignment * Alignment;
+        if (current >= chunks.size() || used + bytes > chunks[current].size()) {
+            if (current < chunks.size())
+                current++; // the following chunks are free
+            used = 0;
+            if (current == chunks.size())
+                chunks.push_back(vector<char>(max(ChunkSize, bytes)));
+            else if (chunks[current].size() < bytes)
+                chunks[current].resize(bytes);
+        }
+        void* p = &chunks[current][used];
+        used += bytes;
+        return p;
+    }
+
+public:
+    /// \brief position of the next array, to be released to
+    struct Mark {
+        size_t chunk;
+        size_t used;
+    };
+
+    Scratch()
+        : current(0)
+        , used(0)
+    {
+    }
+
+    /// \brief uninitialized array of \a n elements, valid until the release of the enclosing ScratchScope
+    template <class T>
+    T* alloc(size_t n) { return (T*)allocate(max((size_t)1, n) * sizeof(T)); }
+
+    Mark mark() const { return { current, used }; }
+    void release(const Mark& m)
+    {
+        current = m.chunk;
+        used = m.used;
+    }
+};
+
+/// \brief releases the arrays allocated in \a scratch since its creation when it goes out of scope
+class ScratchScope {
+    Scratch& scratch;
+    Scratch::Mark m;
+
+public:
+    explicit ScratchScope(Scratch& s)
+        : scratch(s)
+        , m(s.mark())
+    {
+    }
+    ~ScratchScope() { scratch.release(m); }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+};
+
+#endif /*TB2SCRATCH_HPP_*/
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
@@ -14,8 +14,13 @@
  *  - Store::storeVariable for backtrackable lists of variables
  *  - Store::storeSeparator for backtrackable lists of separators (see tree decomposition methods)
  *  - Store::storeBigInteger for very large integers ::StoreBigInteger used in solution counting methods
+ *  - Store::storeWord for 64-bit words ::StoreWord (bitsets of small enumerated domains)
+ *  - Store::storeCostBlock for blocks of storable cost arrays ::StoreCostArray and ::StoreCostTable (cost tables of binary and ternary cost functions)
+ *  - Store::storeCostArray and Store::storeCostTable for size or encoding changes of ::StoreCostArray and ::StoreCostTable
  *
  *  Memory for each stack is dynamically allocated by part of \f$2^x\f$ with \e x initialized to ::STORE_SIZE and increased when needed.
+ *  Under Linux, stacks of trivial types reserve \f$2^y\f$ entries of virtual memory with \e y equal to ::STORE_RESERVE, pages being
+ *  committed only when first used (with transparent huge pages beyond the first \f$2^x\f$ entries), and grow without any copy.
  *  \note storable data are not trailed at depth 0.
  *  \warning ::StoreInt uses Store::storeValue stack (it assumes Value is encoded as int!).
  *  \warning Current storable data management is not multi-threading safe! (Store is a static virtual class relying on StoreBasic<T> static members)
@@ -26,6 +31,11 @@
 
 #include "core/tb2types.hpp"
 
+#ifdef LINUX
+#include <sys/mman.h>
+#include <type_traits>
+#endif
+
 #ifndef NUMBERJACK
 #ifdef BOOST
 #include <boost/version.hpp>
@@ -39,6 +49,25 @@
 #endif
 #endif
 
+/// \brief a block of costs of the size of a cache line, the trailing unit of ::StoreCostArray
+const int CostBlockSize = (64 / sizeof(Cost) > 0) ? (64 / sizeof(Cost)) : 1;
+struct CostBlock {
+    Cost costs[CostBlockSize];
+};
+
+class StoreCostArray;
+class StoreCostTable;
+/// \brief memory of a ::StoreCostArray or ::StoreCostTable, kept for backtracking when it is reallocated
+struct CostTableFormat {
+    char* buffer; ///< allocated memory
+    void* data; ///< first element, aligned on 64 bytes inside buffer
+    size_t size; ///< number of elements
+    int width; ///< ::CostWidth
+    Cost base;
+    unsigned int shift; ///< log2 of the size of an element (::StoreCostTable only)
+    uint64_t mask; ///< bits of an element in a little-endian 64-bit word (::StoreCostTable only)
+};
+
 template <class T>
 class BTList;
 template <class T>
@@ -59,11 +88,71 @@ class StoreStack {
     ptrdiff_t index;
     ptrdiff_t indexMax;
     ptrdiff_t base;
+    size_t reserved; ///< number of entries mapped in virtual memory for each array, or 0 if they are allocated by new
 
     // make it private because we don't want copy nor assignment
     StoreStack(const StoreStack& s);
     StoreStack& operator=(const StoreStack& s);
 
+    static string typeName()
+    {
+#ifndef NUMBERJACK
+#if (BOOST_VERSION >= 105600)
+        return boost::typeindex::type_id<T>().pretty_name();
+#else
+        return typeid(T).name();
+#endif
+#else
+        return "";
+#endif
+    }
+
+    static void outOfMemory()
+    {
+        cerr << typeName() << " stack out of memory!" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+#ifdef LINUX
+    /// \brief maps \a bytes of virtual memory committed on first use, with transparent huge pages after the first \a hugeFrom bytes
+    /// \return NULL if the mapping failed
+    static void* mapMemory(size_t bytes, size_t hugeFrom)
+    {
+        void* mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (mem == MAP_FAILED)
+            return NULL;
+#ifdef MADV_HUGEPAGE
+        const uintptr_t hugePageSize = 2 << 20;
+        uintptr_t start = ((uintptr_t)mem + hugeFrom + hugePageSize - 1) & ~(hugePageSize - 1);
+        if (start < (uintptr_t)mem + bytes)
+            madvise((void*)start, (uintptr_t)mem + bytes - start, MADV_HUGEPAGE); // only a hint, errors are ignored
+#endif
+        return mem;
+    }
+
+    /// \brief reserves virtual memory for both arrays (only for types which do not need to be constructed)
+    /// \return false if not possible (arrays must be allocated by new)
+    bool reserve()
+    {
+        if (!std::is_trivially_copyable<V>::value || !std::is_trivially_default_constructible<V>::value)
+            return false;
+        size_t entries = max((size_t)indexMax, (size_t)1 << STORE_RESERVE);
+        void* mempointers = mapMemory(entries * sizeof(T*), indexMax * sizeof(T*));
+        void* memcontent = mapMemory(entries * sizeof(V), indexMax * sizeof(V));
+        if (!mempointers || !memcontent) {
+            if (mempointers)
+                munmap(mempointers, entries * sizeof(T*));
+            if (memcontent)
+                munmap(memcontent, entries * sizeof(V));
+            return false;
+        }
+        pointers = (T**)mempointers;
+        content = (V*)memcontent;
+        reserved = entries;
+        return true;
+    }
+#endif
+
 public:
     StoreStack(int powbckmemory = STORE_SIZE)
     {
@@ -72,63 +161,70 @@ public:
             exit(EXIT_FAILURE);
         }
         indexMax = (ptrdiff_t)pow(2., powbckmemory);
-        pointers = new T*[indexMax];
-        content = new V[indexMax];
+        reserved = 0;
+#ifdef LINUX
+        if (!reserve())
+#endif
+        {
+            pointers = new T*[indexMax];
+            content = new V[indexMax];
+        }
         index = 0;
         base = 0;
         if (ToulBar2::verbose > 0) {
-            cout << "c " << indexMax * (sizeof(V) + sizeof(T*)) << " Bytes allocated for "
-#ifndef NUMBERJACK
-#if (BOOST_VERSION >= 105600)
-                 << boost::typeindex::type_id<T>().pretty_name()
-#else
-                 << typeid(T).name()
-#endif
-#endif
-                 << " stack." << endl;
+            cout << "c " << indexMax * (sizeof(V) + sizeof(T*)) << " Bytes allocated for " << typeName() << " stack." << endl;
         }
     }
 
     ~StoreStack()
     {
+#ifdef LINUX
+        if (reserved) {
+            munmap(pointers, reserved * sizeof(T*));
+            munmap(content, reserved * sizeof(V));
+            return;
+        }
+#endif
         delete[] pointers;
         delete[] content;
     }
 
+    ptrdiff_t size() const { return index; } ///< \return number of trailed entries currently in the stack
+    ptrdiff_t capacity() const { return indexMax; } ///< \return number of allocated entries
+
     void realloc()
     {
-        T** newpointers = new T*[indexMax * 2];
-        V* newcontent = new V[indexMax * 2];
-        if (!newpointers || !newcontent) {
-            cerr
-#ifndef NUMBERJACK
-#if (BOOST_VERSION >= 105600)
-                << boost::typeindex::type_id<T>().pretty_name()
-#else
-                << typeid(T).name()
-#endif
+#ifdef LINUX
+        if (reserved) {
+            if ((size_t)indexMax * 2 > reserved) { // reservation exhausted: the kernel moves the pages to a larger range without copying them
+                void* mempointers = mremap(pointers, reserved * sizeof(T*), reserved * 2 * sizeof(T*), MREMAP_MAYMOVE);
+                if (mempointers == MAP_FAILED)
+                    outOfMemory();
+                pointers = (T**)mempointers;
+                void* memcontent = mremap(content, reserved * sizeof(V), reserved * 2 * sizeof(V), MREMAP_MAYMOVE);
+                if (memcontent == MAP_FAILED)
+                    outOfMemory();
+                content = (V*)memcontent;
+                reserved *= 2;
+            }
+        } else
 #endif
-                << " stack out of memory!" << endl;
-            exit(EXIT_FAILURE);
+        {
+            T** newpointers = new T*[indexMax * 2];
+            V* newcontent = new V[indexMax * 2];
+            if (!newpointers || !newcontent)
+                outOfMemory();
+            std::copy(pointers, pointers + indexMax, newpointers);
+            std::copy(content, content + indexMax, newcontent);
+
+            delete[] pointers;
+            delete[] content;
+            pointers = newpointers;
+            content = newcontent;
         }
-        std::copy(pointers, pointers + indexMax, newpointers);
-        std::copy(content, content + indexMax, newcontent);
-
-        delete[] pointers;
-        delete[] content;
-        pointers = newpointers;
-        content = newcontent;
         indexMax *= 2;
         if (ToulBar2::verbose >= 0) {
-            cout << "c " << indexMax * (sizeof(V) + sizeof(T*)) << " Bytes allocated for "
-#ifndef NUMBERJACK
-#if (BOOST_VERSION >= 105600)
-                 << boost::typeindex::type_id<T>().pretty_name()
-#else
-                 << typeid(T).name()
-#endif
-#endif
-                 << " stack." << endl;
+            cout << "c " << indexMax * (sizeof(V) + sizeof(T*)) << " Bytes allocated for " << typeName() << " stack." << endl;
         }
     }
 
@@ -183,6 +279,19 @@ public:
     {
         *adr[x] = val[x];
     }
+
+    void restore(uint64_t** adr, uint64_t* val, ptrdiff_t x)
+    {
+        *adr[x] = val[x];
+    }
+
+    void restore(CostBlock** adr, CostBlock* val, ptrdiff_t x)
+    {
+        *adr[x] = val[x];
+    }
+
+    void restore(StoreCostArray** adr, CostTableFormat* val, ptrdiff_t x);
+    void restore(StoreCostTable** adr, CostTableFormat* val, ptrdiff_t x);
     template <class Q>
     void restore(BTList<Q>** l, DLink<Q>** elt, ptrdiff_t& x);
 
@@ -267,6 +376,7 @@ typedef StoreBasic<Value> StoreValue;
 typedef StoreValue StoreInt;
 typedef StoreBasic<Cost> StoreCost;
 typedef StoreBasic<BigInteger> StoreBigInteger;
+typedef StoreBasic<uint64_t> StoreWord;
 
 /*
  * Container for all storable stacks
@@ -281,6 +391,10 @@ public:
     static StoreStack<BTList<ConstraintLink>, DLink<ConstraintLink>*> storeConstraint;
     static StoreStack<BTList<Variable*>, DLink<Variable*>*> storeVariable;
     static StoreStack<BTList<Separator*>, DLink<Separator*>*> storeSeparator;
+    static StoreStack<CostBlock, CostBlock> storeCostBlock;
+    static StoreStack<StoreCostArray, CostTableFormat> storeCostArray;
+    static StoreStack<StoreCostTable, CostTableFormat> storeCostTable;
+    static Long stamp; ///< identifies the current state between two calls to store or restore (see ::StoreCostArray)
 
     /// \return the current (backtrack / tree search) depth
     static int getDepth()
@@ -292,26 +406,36 @@ public:
     static void store()
     {
         depth++;
+        stamp++;
         StoreValue::store();
         StoreCost::store();
         StoreBigInteger::store();
+        StoreWord::store();
         storeDomain.store();
         storeConstraint.store();
         storeVariable.store();
         storeSeparator.store();
+        storeCostBlock.store();
+        storeCostArray.store();
+        storeCostTable.store();
     }
 
     /// restores the current state to the last copy
     static void restore()
     {
         depth--;
+        stamp++;
         StoreValue::restore();
         StoreCost::restore();
         StoreBigInteger::restore();
+        StoreWord::restore();
         storeDomain.restore();
         storeConstraint.restore();
         storeVariable.restore();
         storeSeparator.restore();
+        storeCostBlock.restore();
+        storeCostArray.restore();
+        storeCostTable.restore();
     }
 
     /// restore the current state to the copy made at depth \c newDepth
@@ -325,6 +449,423 @@ public:
 
 #define storeIndexList storeDomain
 
+/*
+ * Storable cost arrays
+ */
+/// \brief contiguous array of costs aligned on cache lines and trailed by blocks of ::CostBlockSize costs
+/// \note the first modification of a block after a call to Store::store or Store::restore saves the whole block, further modifications of the same block are not trailed
+/// \warning resizing an array invalidates the blocks trailed so far, it must be done before any modification at depth greater than 0
+class StoreCostArray {
+    Cost* costs; ///< aligned on 64 bytes inside buffer
+    char* buffer;
+    size_t n;
+    vector<Long> stamps; ///< Store::stamp of the last trailing of each block
+
+    void allocate(size_t size)
+    {
+        size_t nbblocks = (size + CostBlockSize - 1) / CostBlockSize;
+        buffer = new char[nbblocks * sizeof(CostBlock) + 64];
+        costs = (Cost*)(buffer + (64 - (uintptr_t)buffer % 64) % 64);
+        n = size;
+        stamps.assign(nbblocks, 0);
+    }
+
+    void trail(size_t i)
+    {
+        size_t block = i / CostBlockSize;
+        if (stamps[block] != Store::stamp) {
+            stamps[block] = Store::stamp;
+            Store::storeCostBlock.store((CostBlock*)(costs + block * CostBlockSize));
+        }
+    }
+
+    /// \brief frees a previous array, or keeps it (blocks may have been trailed in it) to be restored on backtrack at depth greater than 0
+    void release(const CostTableFormat& old)
+    {
+        if (Store::getDepth() > 0) {
+            Store::storeCostArray.store(this, old);
+            std::fill(stamps.begin(), stamps.end(), Store::stamp); // the new array is forgotten on backtrack
+        } else
+            delete[] old.buffer;
+    }
+
+public:
+    /// \brief modifiable element, trailed when assigned
+    class reference {
+        StoreCostArray& array;
+        size_t i;
+
+    public:
+        reference(StoreCostArray& a, size_t idx)
+            : array(a)
+            , i(idx)
+        {
+        }
+        operator Cost() const { return array.costs[i]; }
+        reference& operator=(const Cost c)
+        {
+            array.trail(i);
+            array.costs[i] = c;
+            return *this;
+        }
+        reference& operator=(const reference& r) { return *this = (Cost)r; }
+        reference& operator+=(const Cost c)
+        {
+            array.trail(i);
+            array.costs[i] += c;
+            return *this;
+        }
+        reference& operator-=(const Cost c)
+        {
+            array.trail(i);
+            array.costs[i] -= c;
+            return *this;
+        }
+    };
+
+    explicit StoreCostArray(size_t size = 0, Cost c = MIN_COST)
+    {
+        allocate(size);
+        std::fill(costs, costs + n, c);
+    }
+    StoreCostArray(const StoreCostArray& a)
+    {
+        allocate(a.n);
+        std::copy(a.costs, a.costs + n, costs);
+    }
+    /// \note at depth greater than 0, the previous array is restored on backtrack as with resize
+    StoreCostArray& operator=(const StoreCostArray& a)
+    {
+        if (&a != this) {
+            CostTableFormat old = { buffer, costs, n, COSTWIDTH_PLAIN, MIN_COST };
+            allocate(a.n);
+            std::copy(a.costs, a.costs + n, costs);
+            release(old);
+        }
+        return *this;
+    }
+    ~StoreCostArray() { delete[] buffer; }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    Cost operator[](size_t i) const { return costs[i]; }
+    reference operator[](size_t i) { return reference(*this, i); }
+    const Cost* data() const { return costs; } ///< \warning read-only access without trailing
+
+    /// \brief enlarges the array (never shrinks it), new elements are set to \a c
+    /// \note at depth greater than 0, the previous array is kept (blocks may have been trailed in it) and restored on backtrack
+    void resize(size_t size, Cost c = MIN_COST)
+    {
+        if (size <= n)
+            return;
+        CostTableFormat old = { buffer, costs, n, COSTWIDTH_PLAIN, MIN_COST };
+        allocate(size);
+        std::copy((Cost*)old.data, (Cost*)old.data + old.size, costs);
+        std::fill(costs + old.size, costs + n, c);
+        release(old);
+    }
+
+    /// \brief same as resize, the previous array being freed at once at any depth, such that the new one is kept on backtrack
+    /// \warning only for the cost functions of the elimination pools which are not in use, none of their blocks being trailed (see WCSP::newTernaryConstr)
+    void enlarge(size_t size, Cost c = MIN_COST)
+    {
+        if (size <= n)
+            return;
+        char* oldbuffer = buffer;
+        Cost* oldcosts = costs;
+        size_t oldn = n;
+        allocate(size);
+        std::copy(oldcosts, oldcosts + oldn, costs);
+        std::fill(costs + oldn, costs + n, c);
+        delete[] oldbuffer;
+    }
+
+    /// \brief replaces all the costs (and the size) of the array
+    /// \note at depth greater than 0, the previous array is restored on backtrack as with resize
+    void assign(const vector<Cost>& values)
+    {
+        CostTableFormat old = { buffer, costs, n, COSTWIDTH_PLAIN, MIN_COST };
+        allocate(values.size());
+        std::copy(values.begin(), values.end(), costs);
+        release(old);
+    }
+
+    /// \brief goes back to a previous array (on backtrack)
+    void restoreArray(const CostTableFormat& old)
+    {
+        delete[] buffer;
+        buffer = old.buffer;
+        costs = (Cost*)old.data;
+        n = old.size;
+        stamps.assign((n + CostBlockSize - 1) / CostBlockSize, 0);
+    }
+};
+
+template <class T, class V>
+void StoreStack<T, V>::restore(StoreCostArray** adr, CostTableFormat* val, ptrdiff_t x)
+{
+    adr[x]->restoreArray(val[x]);
+}
+
+/// \brief storable cost table with costs encoded on 16 or 32 bits as unsigned offsets from a base cost if possible, or as plain costs
+/// \note the encoding is chosen by narrow (at depth 0) and widened automatically when a new cost does not fit
+/// \note costs are trailed by blocks of 64 bytes as in ::StoreCostArray, changes of encoding or size are trailed in Store::storeCostTable
+class StoreCostTable {
+    CostTableFormat f;
+    vector<Long> stamps; ///< Store::stamp of the last trailing of each block
+
+    static size_t elementSize(int width) { return (width == COSTWIDTH_16) ? sizeof(uint16_t) : ((width == COSTWIDTH_32) ? sizeof(uint32_t) : sizeof(Cost)); }
+    static Cost maxOffset(int width) { return (width == COSTWIDTH_16) ? (Cost)UINT16_MAX : ((width == COSTWIDTH_32) ? (Cost)UINT32_MAX : MIN_COST); }
+
+    /// \note 64 extra bytes allow vector instructions to read a few bytes after the last element
+    static CostTableFormat allocate(size_t size, int width, Cost base)
+    {
+        CostTableFormat format;
+        format.buffer = new char[size * elementSize(width) + 2 * 64];
+        format.data = format.buffer + (64 - (uintptr_t)format.buffer % 64) % 64;
+        format.size = size;
+        format.width = width;
+        format.base = base;
+        format.shift = (width == COSTWIDTH_16) ? 1 : ((width == COSTWIDTH_32) ? 2 : 3);
+        format.mask = (width == COSTWIDTH_16) ? (uint64_t)UINT16_MAX : ((width == COSTWIDTH_32) ? (uint64_t)UINT32_MAX : UINT64_MAX);
+        return format;
+    }
+
+    /// \note on little-endian processors with 64-bit costs, offsets are read without branching on their width as a masked 64-bit word
+    static Cost get(const CostTableFormat& format, size_t i)
+    {
+        if (format.width == COSTWIDTH_PLAIN)
+            return ((const Cost*)format.data)[i];
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (sizeof(Cost) == sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, (const char*)format.data + (i << format.shift), sizeof(word));
+            return format.base + (Cost)(word & format.mask);
+        }
+#endif
+        switch (format.width) {
+        case COSTWIDTH_16:
+            return format.base + (Cost)((const uint16_t*)format.data)[i];
+        case COSTWIDTH_32:
+            return format.base + (Cost)((const uint32_t*)format.data)[i];
+        default:
+            return ((const Cost*)format.data)[i];
+        }
+    }
+
+    static void put(CostTableFormat& format, size_t i, Cost c)
+    {
+        switch (format.width) {
+        case COSTWIDTH_16:
+            ((uint16_t*)format.data)[i] = (uint16_t)(c - format.base);
+            break;
+        case COSTWIDTH_32:
+            ((uint32_t*)format.data)[i] = (uint32_t)(c - format.base);
+            break;
+        default:
+            ((Cost*)format.data)[i] = c;
+        }
+    }
+
+    bool fits(Cost c) const { return f.width == COSTWIDTH_PLAIN || (c >= f.base && c - f.base <= maxOffset(f.width)); }
+
+    void trail(size_t i)
+    {
+        size_t block = i * elementSize(f.width) / sizeof(CostBlock);
+        if (stamps[block] != Store::stamp) {
+            stamps[block] = Store::stamp;
+            Store::storeCostBlock.store((CostBlock*)((char*)f.data + block * sizeof(CostBlock)));
+        }
+    }
+
+    /// \brief replaces the current encoding by \a format, the previous one being kept for backtracking if depth is greater than 0
+    void change(const CostTableFormat& format)
+    {
+        Long stamp = 0;
+        if (Store::getDepth() > 0) {
+            Store::storeCostTable.store(this, f);
+            stamp = Store::stamp; // the new encoding is forgotten on backtrack
+        } else
+            delete[] f.buffer;
+        f = format;
+        stamps.assign((f.size * elementSize(f.width) + sizeof(CostBlock) - 1) / sizeof(CostBlock), stamp);
+    }
+
+    void encode(int width, Cost base)
+    {
+        CostTableFormat format = allocate(f.size, width, base);
+        for (size_t i = 0; i < f.size; i++)
+            put(format, i, get(f, i));
+        change(format);
+    }
+
+    /// \brief base cost of an encoding of the costs in [minc,maxc]
+    /// \note ::MIN_COST unless a cost is smaller, such that decreasing costs (by projections) does not widen the encoding at each search node
+    static Cost bestBase(Cost minc) { return min(minc, MIN_COST); }
+
+    /// \brief chooses the smallest encoding for the costs in [minc,maxc]
+    static int bestWidth(Cost minc, Cost maxc)
+    {
+        if (minc > maxc || maxc - minc <= maxOffset(COSTWIDTH_16))
+            return COSTWIDTH_16;
+        if (sizeof(uint32_t) < sizeof(Cost) && maxc - minc <= maxOffset(COSTWIDTH_32))
+            return COSTWIDTH_32;
+        return COSTWIDTH_PLAIN;
+    }
+
+    /// \brief widens the encoding such that \a c can be stored
+    void widen(Cost c)
+    {
+        Cost minc = c, maxc = c;
+        for (size_t i = 0; i < f.size; i++) {
+            Cost ci = get(f, i);
+            minc = min(minc, ci);
+            maxc = max(maxc, ci);
+        }
+        int width = max(f.width + 1, bestWidth(bestBase(minc), maxc));
+        encode(width, (width == COSTWIDTH_PLAIN) ? MIN_COST : bestBase(minc));
+    }
+
+public:
+    /// \brief modifiable element, trailed when assigned
+    class reference {
+        StoreCostTable& table;
+        size_t i;
+
+    public:
+        reference(StoreCostTable& t, size_t idx)
+            : table(t)
+            , i(idx)
+        {
+        }
+        operator Cost() const { return get(table.f, i); }
+        reference& operator=(const Cost c)
+        {
+            table.set(i, c);
+            return *this;
+        }
+        reference& operator=(const reference& r) { return *this = (Cost)r; }
+        reference& operator+=(const Cost c) { return *this = get(table.f, i) + c; }
+        reference& operator-=(const Cost c) { return *this = get(table.f, i) - c; }
+    };
+
+    explicit StoreCostTable(size_t size = 0, Cost c = MIN_COST)
+    {
+        f = allocate(size, COSTWIDTH_PLAIN, MIN_COST);
+        std::fill((Cost*)f.data, (Cost*)f.data + size, c);
+        stamps.assign((size * sizeof(Cost) + sizeof(CostBlock) - 1) / sizeof(CostBlock), 0);
+    }
+    StoreCostTable(const StoreCostTable& t)
+        : stamps(t.stamps.size(), 0)
+    {
+        f = allocate(t.f.size, t.f.width, t.f.base);
+        std::copy((char*)t.f.data, (char*)t.f.data + f.size * elementSize(f.width), (char*)f.data);
+    }
+    /// \note at depth greater than 0, the previous encoding is restored on backtrack (see change)
+    StoreCostTable& operator=(const StoreCostTable& t)
+    {
+        if (&t != this) {
+            CostTableFormat format = allocate(t.f.size, t.f.width, t.f.base);
+            std::copy((char*)t.f.data, (char*)t.f.data + format.size * elementSize(format.width), (char*)format.data);
+            change(format);
+        }
+        return *this;
+    }
+    ~StoreCostTable() { delete[] f.buffer; }
+
+    size_t size() const { return f.size; }
+    bool empty() const { return f.size == 0; }
+    Cost operator[](size_t i) const { return get(f, i); }
+    reference operator[](size_t i) { return reference(*this, i); }
+
+    void set(size_t i, Cost c)
+    {
+        if (!fits(c))
+            widen(c);
+        trail(i);
+        put(f, i, c);
+    }
+
+    const void* element(size_t i) const { return (const char*)f.data + i * elementSize(f.width); } ///< \warning read-only access without trailing
+    int getWidth() const { return f.width; } ///< \return the current ::CostWidth
+    Cost getBase() const { return f.base; } ///< \return cost of offset zero (or ::MIN_COST for plain costs)
+    size_t memory() const { return f.size * elementSize(f.width); } ///< \return number of bytes used by the costs
+
+    /// \brief chooses the smallest encoding for the current costs
+    void narrow()
+    {
+        if (f.size == 0)
+            return;
+        Cost minc = get(f, 0), maxc = minc;
+        for (size_t i = 1; i < f.size; i++) {
+            Cost ci = get(f, i);
+            minc = min(minc, ci);
+            maxc = max(maxc, ci);
+        }
+        int width = bestWidth(bestBase(minc), maxc);
+        if (width != f.width || (width != COSTWIDTH_PLAIN && bestBase(minc) != f.base))
+            encode(width, (width == COSTWIDTH_PLAIN) ? MIN_COST : bestBase(minc));
+    }
+
+    /// \brief enlarges the table (never shrinks it) with plain costs, new elements are set to \a c
+    void resize(size_t size, Cost c = MIN_COST)
+    {
+        if (size <= f.size)
+            return;
+        CostTableFormat format = allocate(size, COSTWIDTH_PLAIN, MIN_COST);
+        for (size_t i = 0; i < f.size; i++)
+            put(format, i, get(f, i));
+        for (size_t i = f.size; i < size; i++)
+            put(format, i, c);
+        change(format);
+    }
+
+    /// \brief same as resize, the previous encoding being freed at once at any depth, such that the new table is kept on backtrack
+    /// \warning only for the cost functions of the elimination pools which are not in use, none of their blocks being trailed (see WCSP::newBinaryConstr)
+    void enlarge(size_t size, Cost c = MIN_COST)
+    {
+        if (size <= f.size)
+            return;
+        CostTableFormat format = allocate(size, COSTWIDTH_PLAIN, MIN_COST);
+        for (size_t i = 0; i < f.size; i++)
+            put(format, i, get(f, i));
+        for (size_t i = f.size; i < size; i++)
+            put(format, i, c);
+        delete[] f.buffer;
+        f = format;
+        stamps.assign((f.size * elementSize(f.width) + sizeof(CostBlock) - 1) / sizeof(CostBlock), 0);
+    }
+
+    /// \brief replaces all the costs (and the size) of the table, in the smallest encoding
+    void assign(const vector<Cost>& values)
+    {
+        Cost minc = MIN_COST, maxc = MIN_COST;
+        if (!values.empty()) {
+            minc = *min_element(values.begin(), values.end());
+            maxc = *max_element(values.begin(), values.end());
+        }
+        int width = bestWidth(bestBase(minc), maxc);
+        CostTableFormat format = allocate(values.size(), width, (width == COSTWIDTH_PLAIN) ? MIN_COST : bestBase(minc));
+        for (size_t i = 0; i < values.size(); i++)
+            put(format, i, values[i]);
+        change(format);
+    }
+
+    /// \brief goes back to a previous encoding (on backtrack)
+    void restoreFormat(const CostTableFormat& format)
+    {
+        delete[] f.buffer;
+        f = format;
+        stamps.assign((f.size * elementSize(f.width) + sizeof(CostBlock) - 1) / sizeof(CostBlock), 0);
+    }
+};
+
+template <class T, class V>
+void StoreStack<T, V>::restore(StoreCostTable** adr, CostTableFormat* val, ptrdiff_t x)
+{
+    adr[x]->restoreFormat(val[x]);
+}
+
 #endif /*TB2STORE_HPP_*/
 
 /* Local Variables: */
@@ -21,6 +21,8 @@ const char* PrintFormatProb = "%lf";
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <sys/times.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 //double cpuTime()
 //{
@@ -87,6 +89,48 @@ void timerStop()
     ToulBar2::interrupted = false;
 }
 
+double realTime()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + tv.tv_usec / 1000000.;
+}
+
+size_t residentMemory()
+{
+    long pages = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f) {
+        if (fscanf(f, "%*s %ld", &pages) != 1)
+            pages = 0;
+        fclose(f);
+    }
+    return (size_t)pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/* open a file or connect to a Unix-domain socket (name prefixed by "unix:") */
+FILE* openStream(const char* name)
+{
+    if (strncmp(name, "unix:", 5) == 0) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (strlen(name + 5) >= sizeof(addr.sun_path))
+            return NULL;
+        strcpy(addr.sun_path, name + 5);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return NULL;
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            return NULL;
+        }
+        signal(SIGPIPE, SIG_IGN); // a closed peer must not kill the solver
+        return fdopen(fd, "w");
+    }
+    return fopen(name, "w");
+}
+
 #else
 double cpuTime()
 {
@@ -94,6 +138,12 @@ double cpuTime()
 }
 void timer(int t) {}
 void timerStop() {}
+double realTime() { return (double)time(NULL); }
+size_t residentMemory() { return 0; }
+FILE* openStream(const char* name)
+{
+    return (strncmp(name, "unix:", 5) == 0) ? NULL : fopen(name, "w");
+}
 #endif
 
 /* Local Variables: */
@@ -22,6 +22,9 @@ double cpuTime(); ///< \brief return CPU time in seconds with high resolution (m
 void timeOut(int sig);
 void timer(int t); ///< \brief set a timer (in seconds)
 void timerStop(); ///< \brief stop a timer
+double realTime(); ///< \brief return wall-clock time in seconds since the Epoch
+size_t residentMemory(); ///< \brief return current resident set size in bytes (0 if unknown)
+FILE* openStream(const char* name); ///< \brief open a write stream on a file or on a Unix-domain socket given as \e unix:path (NULL on failure)
 
 #ifdef WIDE_STRING
 typedef wchar_t Char;
@@ -0,0 +1,281 @@
+/** \file tb2tupletable.hpp
+ *  \brief Flat table of costs indexed by tuples, with the interface of \c map<String,Cost>.
+ *
+ * Tuples (all of the same length) are packed contiguously with their costs, an open-addressing hash table
+ * giving the position of each tuple. Iteration is done in increasing lexicographic order of the tuples
+ * (as with a map), the entries being sorted lazily when an iteration starts after insertions out of order.
+ * Erased entries are only marked as such (and a new insertion of the same tuple reuses them) until the next sort.
+ *
+ * \warning inserting a new tuple invalidates the iterators, modifying the cost of an existing tuple does not
+ */
+
+#ifndef TB2TUPLETABLE_HPP_
+#define TB2TUPLETABLE_HPP_
+
+#include "core/tb2types.hpp"
+
+class TupleTable {
+    size_t arity; ///< length of the tuples (0 until the first insertion)
+    vector<Char> keys; ///< arity characters per entry
+    vector<Cost> values;
+    vector<char> live; ///< zero if the entry has been erased
+    vector<unsigned int> slots; ///< hash table of entry positions plus one (zero if empty slot), size is a power of two
+    size_t nbLive;
+    bool sorted; ///< true if the entries are in increasing order
+
+    size_t hash(const Char* key) const
+    {
+        size_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < arity; i++) {
+            h ^= (size_t)key[i];
+            h *= 1099511628211ULL;
+        }
+        return h ^ (h >> 29);
+    }
+
+    /// \return the slot containing the entry of \a key, or the empty slot where it should be inserted
+    size_t lookup(const Char* key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t s = hash(key) & mask;
+        while (slots[s] && String::traits_type::compare(&keys[(slots[s] - 1) * arity], key, arity) != 0)
+            s = (s + 1) & mask;
+        return s;
+    }
+
+    void rehash(size_t nbslots)
+    {
+        slots.assign(nbslots, 0);
+        for (size_t e = 0; e < values.size(); e++)
+            slots[lookup(&keys[e * arity])] = e + 1;
+    }
+
+    /// \brief sorts the entries in increasing order of tuples, removing erased entries
+    void sort()
+    {
+        vector<unsigned int> order;
+        order.reserve(nbLive);
+        for (size_t e = 0; e < values.size(); e++)
+            if (live[e])
+                order.push_back(e);
+        const Char* k = keys.data();
+        size_t a = arity;
+        std::sort(order.begin(), order.end(), [k, a](unsigned int e1, unsigned int e2) { return String::traits_type::compare(&k[e1 * a], &k[e2 * a], a) < 0; });
+        vector<Char> newkeys(order.size() * arity);
+        vector<Cost> newvalues(order.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            std::copy(&keys[order[i] * arity], &keys[order[i] * arity] + arity, &newkeys[i * arity]);
+            newvalues[i] = values[order[i]];
+        }
+        keys.swap(newkeys);
+        values.swap(newvalues);
+        live.assign(values.size(), 1);
+        rehash(slots.size());
+        sorted = true;
+    }
+
+public:
+    /// \brief modifiable cost of an entry
+    class reference {
+        Cost* c;
+
+    public:
+        reference(Cost* cost)
+            : c(cost)
+        {
+        }
+        operator Cost() const { return *c; }
+        reference& operator=(const Cost v)
+        {
+            *c = v;
+            return *this;
+        }
+        reference& operator=(const reference& r) { return *this = (Cost)r; }
+        void rebind(Cost* cost) { c = cost; }
+        reference& operator+=(const Cost v)
+        {
+            *c += v;
+            return *this;
+        }
+        reference& operator-=(const Cost v)
+        {
+            *c -= v;
+            return *this;
+        }
+    };
+
+    /// \brief tuple and cost of an entry, as \c pair<const String,Cost>
+    struct value_type {
+        String first;
+        reference second;
+        value_type()
+            : second(NULL)
+        {
+        }
+    };
+
+    class iterator {
+        TupleTable* table;
+        size_t pos;
+        value_type entry;
+        size_t entryPos; ///< position of the tuple currently copied in \c entry.first
+
+        void skip()
+        {
+            while (pos < table->values.size() && !table->live[pos])
+                pos++;
+        }
+
+    public:
+        iterator()
+            : table(NULL)
+            , pos(0)
+            , entryPos(SIZE_MAX)
+        {
+        }
+        iterator(TupleTable* t, size_t p)
+            : table(t)
+            , pos(p)
+            , entryPos(SIZE_MAX)
+        {
+            skip();
+        }
+        iterator(const iterator& it)
+            : table(it.table)
+            , pos(it.pos)
+            , entryPos(SIZE_MAX)
+        {
+        }
+        iterator& operator=(const iterator& it)
+        {
+            table = it.table;
+            pos = it.pos;
+            entryPos = SIZE_MAX;
+            return *this;
+        }
+        value_type& operator*()
+        {
+            if (entryPos != pos) {
+                entry.first.assign(&table->keys[pos * table->arity], table->arity);
+                entryPos = pos;
+            }
+            entry.second.rebind(&table->values[pos]);
+            return entry;
+        }
+        value_type* operator->() { return &**this; }
+        iterator& operator++()
+        {
+            pos++;
+            skip();
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator it(*this);
+            ++*this;
+            return it;
+        }
+        bool operator==(const iterator& it) const { return pos == it.pos; }
+        bool operator!=(const iterator& it) const { return pos != it.pos; }
+
+        friend class TupleTable;
+    };
+
+    TupleTable()
+        : arity(0)
+        , slots(16, 0)
+        , nbLive(0)
+        , sorted(true)
+    {
+    }
+
+    size_t size() const { return nbLive; }
+    bool empty() const { return nbLive == 0; }
+    /// \return number of bytes used by the table
+    size_t memory() const { return keys.capacity() * sizeof(Char) + values.capacity() * sizeof(Cost) + live.capacity() + slots.capacity() * sizeof(unsigned int); }
+
+    iterator begin()
+    {
+        if (!sorted)
+            sort();
+        return iterator(this, 0);
+    }
+    iterator end() { return iterator(this, values.size()); }
+
+    /// \return the cost of \a key, or \a defaultCost if missing (same as \c find without building an iterator)
+    Cost get(const String& key, Cost defaultCost) const
+    {
+        if (key.size() != arity)
+            return defaultCost;
+        size_t s = lookup(key.data());
+        return (slots[s] && live[slots[s] - 1]) ? values[slots[s] - 1] : defaultCost;
+    }
+
+    iterator find(const String& key)
+    {
+        if (key.size() != arity)
+            return end();
+        size_t s = lookup(key.data());
+        if (slots[s] == 0 || !live[slots[s] - 1])
+            return end();
+        return iterator(this, slots[s] - 1);
+    }
+
+    /// \brief cost of \a key, inserted with a zero cost if missing
+    reference operator[](const String& key)
+    {
+        if (nbLive == 0 && key.size() != arity) {
+            clear();
+            arity = key.size();
+        }
+        assert(key.size() == arity);
+        size_t s = lookup(key.data());
+        if (slots[s]) {
+            size_t e = slots[s] - 1;
+            if (!live[e]) {
+                live[e] = 1;
+                values[e] = MIN_COST;
+                nbLive++;
+            }
+            return reference(&values[e]);
+        }
+        size_t e = values.size();
+        if (sorted && e > 0 && String::traits_type::compare(&keys[(e - 1) * arity], key.data(), arity) > 0)
+            sorted = false;
+        keys.insert(keys.end(), key.begin(), key.end());
+        values.push_back(MIN_COST);
+        live.push_back(1);
+        nbLive++;
+        slots[s] = e + 1;
+        if (2 * values.size() > slots.size())
+            rehash(2 * slots.size());
+        return reference(&values[e]);
+    }
+
+    void erase(const iterator& it)
+    {
+        assert(live[it.pos]);
+        live[it.pos] = 0;
+        nbLive--;
+    }
+
+    void clear()
+    {
+        arity = 0;
+        keys.clear();
+        values.clear();
+        live.clear();
+        slots.assign(16, 0);
+        nbLive = 0;
+        sorted = true;
+    }
+};
+
+#endif /*TB2TUPLETABLE_HPP_*/
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* tab-width: 4 */
+/* indent-tabs-mode: nil */
+/* c-default-style: "k&r" */
+/* End: */
@@ -36,6 +36,7 @@
 #include <functional>
 #include <algorithm>
 #include <numeric>
+#include <bitset>
 using namespace std;
 #ifdef BOOST
 #include <boost/tokenizer.hpp>
@@ -0,0 +1,116 @@
+# command line options of the cover tests, one list per problem file name
+# each option string gives a new test checked with the test_regexp of the problem directory
+
+set (dense12.wcsp
+  "--telemetry=dense12-telemetry.json --telemetry-period=0"
+  "-kernels=0"
+  "-kernels=1"
+  "-kernels=2"
+  "-kernels=3"
+  "-prethreads=4"
+  )
+
+set (binary60.wcsp
+  "-l=3"
+  "-l=3 -ldsjobs=2"
+  "-l=3 -ldsjobs=4"
+  "-L=100"
+  "-L=100 -nogoods=100"
+  "-L=100 -nogoods=10"
+  "-dyncomp=1"
+  "-dyncomp=10"
+  "-hbfs: -dyncomp=1"
+  "-waves"
+  "-waves -hbfs:"
+  "-dee=2 -deematrix"
+  "-dee=4 -deematrix -prethreads=4"
+  "-S"
+  "-S -sacjobs=2"
+  "-S -sacjobs=4"
+  "-trws"
+  "-trws -kernels=0"
+  "-trws --trws-order -prethreads=4"
+  "-A -prethreads=4"
+  "-A -M=100"
+  "-A -M=100 -prethreads=4"
+  "-A=100"
+  "-A=100 -vacwarm"
+  )
+
+set (ternary12b.wcsp
+  "-l=3"
+  "-l=3 -ldsjobs=2"
+  "-l=3 -ldsjobs=4"
+  "-L=100"
+  "-L=100 -nogoods=100"
+  "-L=100 -nogoods=10"
+  "-dyncomp=1"
+  "-dyncomp=10"
+  "-hbfs: -dyncomp=1"
+  "-waves"
+  "-waves -hbfs:"
+  "-S -sacjobs=4"
+  )
+
+set (nary12.wcsp
+  "-l=3"
+  "-l=3 -ldsjobs=2"
+  "-l=3 -ldsjobs=4"
+  "-L=100"
+  "-L=100 -nogoods=100"
+  "-L=100 -nogoods=10"
+  "-dyncomp=1"
+  "-dyncomp=10"
+  "-hbfs: -dyncomp=1"
+  "-waves"
+  "-waves -hbfs:"
+  "-S -sacjobs=4"
+  )
+
+set (dense12offset.wcsp
+  "-kernels=0"
+  "-kernels=1"
+  "-kernels=2"
+  "-kernels=3"
+  )
+
+set (dense12x10000.wcsp
+  "-kernels=0"
+  "-kernels=1"
+  "-kernels=2"
+  "-kernels=3"
+  )
+
+set (dense12x1e9.wcsp
+  "-kernels=0"
+  "-kernels=1"
+  "-kernels=2"
+  "-kernels=3"
+  )
+
+set (sparse25.wcsp
+  "-sparse=0"
+  "-sparse=0.5"
+  "-kernels=0"
+  "-kernels=3"
+  "-prethreads=4"
+  )
+
+set (ternary12.wcsp
+  "-sparset=0"
+  "-sparset=0.5"
+  "-sparse=0 -sparset=0"
+  "-prethreads=4"
+  "-prethreads=4 -sparset=0"
+  )
+
+set (nary14.wcsp
+  "-prethreads=4"
+  )
+
+set (band40.wcsp
+  "-p=8 -hbfs:"
+  "-p=8 -B=1"
+  "-p=8 -kernels=0"
+  "-p=7 -s"
+  )
@@ -0,0 +1,5 @@
+# random binary problem with dense cost tables (12 variables, 8 values)
+# any option which must not change the search has to give the same optimum and tree size
+set (command_line_option "")
+set (test_timeout 60)
+set (test_regexp "Optimum: 124 in 60 backtracks and 162 nodes")
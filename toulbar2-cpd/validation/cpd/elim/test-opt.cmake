@@ -0,0 +1,6 @@
+# random binary problem on a band graph of width 6 with forbidden values and pairs (40 variables, 4 values),
+# solved by generic variable elimination in preprocessing (bucket elimination on dense tables)
+# any option which must not change the search has to give the same optimum and tree size
+set (command_line_option "-p=8")
+set (test_timeout 60)
+set (test_regexp "Optimum: 834 in 0 backtracks and 0 nodes")
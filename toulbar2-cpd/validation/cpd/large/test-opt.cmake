@@ -0,0 +1,5 @@
+# dense validation problem (see ../dense) with costs multiplied by 10^9, binary costs too large for 32 bits
+# same search tree as the original problem
+set (command_line_option "")
+set (test_timeout 60)
+set (test_regexp "Optimum: 124000000000 in 60 backtracks and 162 nodes")
@@ -0,0 +1,5 @@
+# random problem with n-ary cost functions given by their listed tuples (14 variables, 4 values)
+# any option which must not change the search has to give the same optimum and tree size
+set (command_line_option "")
+set (test_timeout 60)
+set (test_regexp "Optimum: 60 in 814 backtracks and 2049 nodes")
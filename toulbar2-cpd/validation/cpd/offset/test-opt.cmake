@@ -0,0 +1,4 @@
+# dense validation problem (see ../dense) with 1000000 added to every binary cost, stored on 16 bits above a base cost
+set (command_line_option "")
+set (test_timeout 60)
+set (test_regexp "Optimum: 34000124 in 62 backtracks and 187 nodes")
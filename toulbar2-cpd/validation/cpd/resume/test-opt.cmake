@@ -0,0 +1,5 @@
+# random binary problem (20 variables, 10 values) solved in a few seconds,
+# also used to interrupt and resume hybrid best-first search (see checkpoint-test.cmake)
+set (command_line_option "")
+set (test_timeout 300)
+set (test_regexp "Optimum: 269 in 35520 backtracks and 87239 nodes")
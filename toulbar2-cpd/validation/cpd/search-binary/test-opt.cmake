@@ -0,0 +1,5 @@
+# random binary problem (60 variables, 6 values)
+# search strategies may explore different trees but must find the same optimum
+set (command_line_option "")
+set (test_timeout 120)
+set (test_regexp "Optimum: 478 in")
@@ -0,0 +1,5 @@
+# random problem with n-ary cost functions (12 variables, 5 values)
+# search strategies may explore different trees but must find the same optimum
+set (command_line_option "")
+set (test_timeout 120)
+set (test_regexp "Optimum: 60 in")
@@ -0,0 +1,5 @@
+# random ternary problem with sparse cost tables and dense binary cost functions (12 variables, 16 values)
+# search strategies may explore different trees but must find the same optimum
+set (command_line_option "")
+set (test_timeout 120)
+set (test_regexp "Optimum: 44 in")
@@ -0,0 +1,5 @@
+# random binary problem with mostly-default cost tables, most of them stored sparsely (25 variables, up to 13 values)
+# any option which must not change the search has to give the same optimum and tree size
+set (command_line_option "")
+set (test_timeout 60)
+set (test_regexp "Optimum: 75 in 72 backtracks and 196 nodes")
@@ -0,0 +1,5 @@
+# random ternary problem with sparse cost tables and dense binary cost functions (12 variables, 16 values)
+# any option which must not change the search has to give the same optimum and tree size
+set (command_line_option "")
+set (test_timeout 120)
+set (test_regexp "Optimum: 35 in 472 backtracks and 1169 nodes")